@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Board.h"
+
+// the same board for the same seed, whatever the thread count, so runs can be compared
+inline void FillBoard(Board& board, double density, uint64_t seed)
+{
+    board.RandomizeBoard(static_cast<float>(density), 100, seed);
+}
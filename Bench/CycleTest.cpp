@@ -0,0 +1,74 @@
+// Checks cycle detection against boards whose future is known, returns non-zero if any check fails.
+//
+// usage: CycleTest
+
+#include <cstdio>
+
+#include "Board.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const char* what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	// a lone cell under B3/S23/C6 dies at once and then decays through 4 stages that are all Decaying in the states,
+	// detection used to take the first of them for a still life and pause or replay the board there
+	void DecayingCellIsNotACycle(CycleAction action)
+	{
+		Rule rule;
+		Check(Rule::Parse("B3/S23/C6", rule), "B3/S23/C6 parses");
+
+		Board board;
+		board.CycleDetection(action);
+		board.Resize(16, 16, 100);
+		board.RandomizeBoard(0.0f, 100);
+		board.TurnCellOn(GridPoint{ 8, 8 }, true);
+		for (int generation = 0; generation < 10; generation++)
+		{
+			board.Update(rule);
+		}
+
+		Check(board.Generation() == 10, "the board isn't paused while the cell decays");
+		Check(board.GetCell(8, 8).GetState() == Cell::State::Dead, "the decayed cell is dead by generation 10");
+		Check(board.GetCycle().period == 0, "no cycle is reported for a decaying cell");
+	}
+
+	// a blinker under B3/S23 is still found, and replayed, with its period
+	void BlinkerIsACycle()
+	{
+		Board board;
+		board.CycleDetection(CycleAction::Replay);
+		board.Resize(16, 16, 100);
+		board.RandomizeBoard(0.0f, 100);
+		for (const uint16_t x : { 7, 8, 9 })
+		{
+			board.TurnCellOn(GridPoint{ x, 8 }, true);
+		}
+		for (int generation = 0; generation < 11; generation++)
+		{
+			board.Update(Rule::Preset(BoardRules::Conway));
+		}
+
+		Check(board.GetCycle().period == 2, "a blinker is a period 2 cycle");
+		Check(board.GetCell(8, 7).IsAlive() && !board.GetCell(7, 8).IsAlive(), "the replayed blinker is in the right phase");
+	}
+}
+
+int main()
+{
+	DecayingCellIsNotACycle(CycleAction::Detect);
+	DecayingCellIsNotACycle(CycleAction::Pause);
+	DecayingCellIsNotACycle(CycleAction::Replay);
+	BlinkerIsACycle();
+
+	std::printf("%s\n", failures == 0 ? "all cycle checks passed" : "cycle checks failed");
+	return failures == 0 ? 0 : 1;
+}
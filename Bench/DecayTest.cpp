@@ -0,0 +1,82 @@
+// Checks that Generations boards keep each decaying cell's stage through edits, returns non-zero if any check fails.
+//
+// usage: DecayTest
+
+#include <cstdio>
+#include <string>
+
+#include "Board.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const std::string& what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	void Run(Board& board, const Rule& rule, int generations)
+	{
+		for (int generation = 0; generation < generations; generation++)
+		{
+			board.Update(rule);
+		}
+	}
+
+	[[nodiscard]] uint32_t Differences(const Board& a, const Board& b)
+	{
+		uint32_t differences = 0;
+		for (uint16_t y = 0; y < a.Height(); y++)
+		{
+			for (uint16_t x = 0; x < a.Width(); x++)
+			{
+				differences += a.GetCell(x, y).GetState() != b.GetCell(x, y).GetState() ? 1 : 0;
+			}
+		}
+		return differences;
+	}
+
+	// a cell turned on and off again changes nothing, the board used to reload every decaying cell at the first stage
+	void EditKeepsDecayStages(const char* text)
+	{
+		Rule rule;
+		Check(Rule::Parse(text, rule), std::string{ text } + " parses");
+
+		Board board;
+		Board edited;
+		for (Board* b : { &board, &edited })
+		{
+			b->Resize(64, 64, 100);
+			b->RandomizeBoard(0.3f, 100, 7);
+			Run(*b, rule, 20);
+		}
+
+		uint16_t x = 0;
+		while (x < 63 && edited.Alive(x, 0))
+		{
+			x++;
+		}
+		edited.TurnCellOn(GridPoint{ x, 0 }, true);
+		edited.TurnCellOn(GridPoint{ x, 0 }, false);
+
+		Run(board, rule, 20);
+		Run(edited, rule, 20);
+		Check(Differences(board, edited) == 0, std::string{ "an edit that undoes itself doesn't change the future under " } + text);
+	}
+}
+
+int main()
+{
+	EditKeepsDecayStages("B3/S23/C3");
+	EditKeepsDecayStages("B3/S23/C6");
+	EditKeepsDecayStages("B2/S345/C4");
+	EditKeepsDecayStages("B2/S/C24");
+
+	std::printf("%s\n", failures == 0 ? "all decay checks passed" : "decay checks failed");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Feeds FrameGovernor synthetic frame timings and checks what it chooses, returns non-zero if any check fails.
+//
+// usage: FrameGovernorTest
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "FrameGovernor.h"
+
+namespace
+{
+	using std::chrono::duration;
+	using std::chrono::duration_cast;
+	using std::chrono::milliseconds;
+	using std::chrono::nanoseconds;
+
+	int failures = 0;
+
+	void Check(bool passed, const char* what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	// a 16 ms budget, so over budget is past 14.4 ms and room to spare is under 9.6 ms
+	FrameGovernor Governor(uint8_t levels, uint32_t maxGenerations)
+	{
+		FrameGovernor governor;
+		governor.Target(milliseconds{ 16 });
+		governor.DetailLevels(levels);
+		governor.MaxGenerationsPerFrame(maxGenerations);
+		governor.Reset();
+		return governor;
+	}
+
+	// a frame that took draw ms to draw and generation ms for each of the generations the governor asked for
+	bool AddFrame(FrameGovernor& governor, double draw, double generation)
+	{
+		FrameTimes times;
+		times.generations = governor.GenerationsPerFrame();
+		times.update = duration_cast<nanoseconds>(duration<double, std::milli>{ generation * times.generations });
+		times.render = duration_cast<nanoseconds>(duration<double, std::milli>{ draw * 0.75 });
+		times.composite = duration_cast<nanoseconds>(duration<double, std::milli>{ draw * 0.25 });
+		return governor.AddFrame(times);
+	}
+
+	// the frames up to and including the next change, 0 if nothing changed in limit frames
+	uint32_t FramesToChange(FrameGovernor& governor, double draw, double generation, uint32_t limit = 200)
+	{
+		for (uint32_t frame = 1; frame <= limit; frame++)
+		{
+			if (AddFrame(governor, draw, generation))
+			{
+				return frame;
+			}
+		}
+		return 0;
+	}
+
+	// drawing over 90% of the budget costs detail before it costs generations
+	void DetailDropsFirst()
+	{
+		FrameGovernor governor = Governor(2, 8);
+		Check(AddFrame(governor, 20.0, 0.1), "a frame that's too slow to draw changes something");
+		Check(governor.Detail() == 1, "detail drops when drawing is over budget");
+		Check(governor.GenerationsPerFrame() == 8, "generations are kept while detail drops");
+
+		FrameGovernor under = Governor(2, 1);
+		Check(FramesToChange(under, 14.0, 0.0) == 0 && under.Detail() == 0, "detail is kept while drawing is under 90% of the budget");
+	}
+
+	// generations go straight down to what fits, and back up by doubling
+	void GenerationsDropAtOnceAndDouble()
+	{
+		FrameGovernor governor = Governor(1, 64);
+
+		// 1 ms to draw and 1 ms a generation leaves room for 13
+		Check(AddFrame(governor, 1.0, 1.0), "too many generations changes something");
+		Check(governor.GenerationsPerFrame() == 13, "generations drop straight to what fits");
+
+		std::vector<uint32_t> steps;
+		while (governor.GenerationsPerFrame() < 64 && FramesToChange(governor, 1.0, 0.01) != 0)
+		{
+			steps.push_back(governor.GenerationsPerFrame());
+		}
+		Check(steps == std::vector<uint32_t>{ 26, 52, 64 }, "generations grow by doubling up to the most asked for");
+	}
+
+	// detail comes back once the estimate for the next level up is under 60% of the budget, not before
+	void DetailReturnsUnderLow()
+	{
+		FrameGovernor governor = Governor(2, 1);
+		Check(AddFrame(governor, 20.0, 0.0), "a frame that's too slow to draw changes something");
+		Check(governor.Detail() == 1, "detail drops when drawing is over budget");
+
+		// the first frame after settling measures level 0 at 5 times the cost of level 1
+		Check(FramesToChange(governor, 4.0, 0.0, FrameGovernor::SettleFrames + 1) == 0, "nothing changes while 20 ms is estimated for level 0");
+
+		// 2 ms at level 1 is 10 ms at level 0, over 9.6 ms, and 1.8 ms is 9 ms, under it
+		Check(FramesToChange(governor, 2.0, 0.0, 500) == 0, "detail stays down while the estimate is over 60% of the budget");
+		Check(FramesToChange(governor, 1.8, 0.0) != 0 && governor.Detail() == 0, "detail comes back once the estimate is under 60% of the budget");
+	}
+
+	// after any change the next SettleFrames frames are only averaged, the one after that can change things again
+	void ChangesWaitToSettle()
+	{
+		FrameGovernor governor = Governor(2, 8);
+		Check(AddFrame(governor, 20.0, 0.1), "detail drops");
+		Check(FramesToChange(governor, 4.0, 2.0) == FrameGovernor::SettleFrames + 1, "the change after a detail change waits to settle");
+		Check(governor.GenerationsPerFrame() == 5, "the generations that fit beside 4 ms of drawing");
+		Check(FramesToChange(governor, 4.0, 0.5) == FrameGovernor::SettleFrames + 1, "the change after a generations change waits to settle");
+		Check(governor.GenerationsPerFrame() == 8, "generations grow once they've settled");
+	}
+}
+
+int main()
+{
+	DetailDropsFirst();
+	GenerationsDropAtOnceAndDouble();
+	DetailReturnsUnderLow();
+	ChangesWaitToSettle();
+
+	std::printf("%s\n", failures == 0 ? "all frame governor checks passed" : "frame governor checks failed");
+	return failures == 0 ? 0 : 1;
+}
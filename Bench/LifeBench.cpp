@@ -0,0 +1,418 @@
+// Runs the simulation with no window, renderer or timer and reports engine throughput.
+//
+// usage: LifeBench [--width 1024] [--height 1024] [--rule fastconway|conway|daynight|lifewithoutdeath|briansbrain|seeds|highlife|B36/S23|...]
+//                  [--density 0.3] [--seed 1] [--threads 4] [--generations 1000] [--warmup 10] [--incremental 0|1]
+//                  [--topology torus|bounded|klein|cross] [--block 1..32] [--cycles off|detect|pause|replay] [--hash 0|1]
+//                  [--rewind MB] [--pattern file.rle|.cells|.lif|.mc] [--macrocell file.mc]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Board.h"
+#include "BenchBoard.h"
+#include "HashLife.h"
+#include "Shape.h"
+
+namespace
+{
+	struct Options
+	{
+		uint16_t width{ 1024 };
+		uint16_t height{ 1024 };
+		std::string rule{ "fastconway" };
+		bool ruleGiven{ false };
+		double density{ 0.3 };
+		uint64_t seed{ 1 };
+		int threads{ 0 };
+		int generations{ 1000 };
+		int warmup{ 10 };
+		bool incremental{ false };
+		std::string topology{ "torus" };
+		int block{ 1 };
+		std::string cycles{ "off" };
+		bool hash{ false };
+		int rewind{ 0 };
+		std::string pattern;
+		std::string macrocell;
+	};
+
+	void Usage()
+	{
+		std::puts("usage: LifeBench [--width N] [--height N] [--rule name|B/S|B/S/C] [--density 0..1] [--seed N] [--threads N] [--generations N] [--warmup N] [--incremental 0|1] [--topology name] [--block N] [--cycles action] [--hash 0|1] [--rewind MB] [--pattern file] [--macrocell file]");
+		std::puts("  topologies: torus bounded klein cross");
+		std::puts("  cycle actions: off detect pause replay");
+		std::puts("  rule names: fastconway conway daynight lifewithoutdeath briansbrain seeds highlife");
+		std::puts("  a pattern is timed loading, then run from the middle of the board in its own rule unless --rule is given");
+		std::puts("  a macrocell file is loaded into HashLife and written back out, both timed, and the board isn't run");
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string_view name{ argv[i] };
+			if (i + 1 >= argc)
+			{
+				return false;
+			}
+			const char* value = argv[++i];
+
+			if (name == "--width") options.width = static_cast<uint16_t>(std::atoi(value));
+			else if (name == "--height") options.height = static_cast<uint16_t>(std::atoi(value));
+			else if (name == "--rule") { options.rule = value; options.ruleGiven = true; }
+			else if (name == "--density") options.density = std::atof(value);
+			else if (name == "--seed") options.seed = std::strtoull(value, nullptr, 10);
+			else if (name == "--threads") options.threads = std::atoi(value);
+			else if (name == "--generations") options.generations = std::atoi(value);
+			else if (name == "--warmup") options.warmup = std::atoi(value);
+			else if (name == "--incremental") options.incremental = std::atoi(value) != 0;
+			else if (name == "--topology") options.topology = value;
+			else if (name == "--block") options.block = std::atoi(value);
+			else if (name == "--cycles") options.cycles = value;
+			else if (name == "--hash") options.hash = std::atoi(value) != 0;
+			else if (name == "--rewind") options.rewind = std::atoi(value);
+			else if (name == "--pattern") options.pattern = value;
+			else if (name == "--macrocell") options.macrocell = value;
+			else return false;
+		}
+		return options.width > 0 && options.height > 0 && options.generations > 0;
+	}
+
+	// a built-in ruleset by name, or any rule string Rule::Parse accepts
+	bool ParseRule(const std::string& text, bool& fastConway, Rule& rule)
+	{
+		struct Named { const char* name; BoardRules rules; };
+		constexpr Named names[]{
+			{ "fastconway", BoardRules::FastConway },
+			{ "conway", BoardRules::Conway },
+			{ "daynight", BoardRules::DayAndNight },
+			{ "lifewithoutdeath", BoardRules::LifeWithoutDeath },
+			{ "briansbrain", BoardRules::BriansBrain },
+			{ "seeds", BoardRules::Seeds },
+			{ "highlife", BoardRules::Highlife },
+		};
+
+		for (const auto& named : names)
+		{
+			if (text == named.name)
+			{
+				fastConway = (named.rules == BoardRules::FastConway);
+				rule = Rule::Preset(named.rules);
+				return true;
+			}
+		}
+
+		fastConway = false;
+		return Rule::Parse(text, rule);
+	}
+
+	bool ParseTopology(const std::string& text, Topology& topology)
+	{
+		struct Named { const char* name; Topology topology; };
+		constexpr Named names[]{
+			{ "torus", Topology::Torus },
+			{ "bounded", Topology::Bounded },
+			{ "klein", Topology::KleinBottle },
+			{ "cross", Topology::CrossSurface },
+		};
+
+		for (const auto& named : names)
+		{
+			if (text == named.name)
+			{
+				topology = named.topology;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ParseCycleAction(const std::string& text, CycleAction& action)
+	{
+		struct Named { const char* name; CycleAction action; };
+		constexpr Named names[]{
+			{ "off", CycleAction::Off },
+			{ "detect", CycleAction::Detect },
+			{ "pause", CycleAction::Pause },
+			{ "replay", CycleAction::Replay },
+		};
+
+		for (const auto& named : names)
+		{
+			if (text == named.name)
+			{
+				action = named.action;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char* FormatName(Shape::Format format)
+	{
+		switch (format)
+		{
+		case Shape::Format::Plaintext: return "plaintext";
+		case Shape::Format::RLE: return "RLE";
+		case Shape::Format::Life106: return "Life 1.06";
+		case Shape::Format::Macrocell: return "macrocell";
+		default: return "unknown";
+		}
+	}
+
+	// reads the file into memory and loads it from there until a quarter second has gone by, so the disk isn't timed
+	bool LoadPattern(const std::string& path, Shape& shape)
+	{
+		std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+		if (!file.is_open())
+		{
+			std::printf("can't open %s\n", path.c_str());
+			return false;
+		}
+		const std::string text{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+		int loads = 0;
+		const auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed{ 0 };
+		do
+		{
+			std::istringstream stream(text);
+			if (!shape.Load(stream))
+			{
+				std::printf("%s isn't a pattern this can read\n", path.c_str());
+				return false;
+			}
+			loads++;
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed.count() < 0.25);
+
+		std::printf("pattern      %s, %s %ux%u, %u live%s%s\n", path.c_str(), FormatName(shape.GetFormat()), shape.Width(), shape.Height(), shape.GetLiveCount(),
+			shape.RuleText().empty() ? "" : ", rule ", shape.RuleText().c_str());
+		std::printf("parse        %.1f MB/s (%zu bytes, %.3f ms a load)\n", static_cast<double>(text.size()) * loads / elapsed.count() / 1e6, text.size(), elapsed.count() * 1000.0 / loads);
+		return true;
+	}
+
+	// counts what's written to it and throws it away, so saving is timed without the disk
+	class CountingBuffer : public std::streambuf
+	{
+	public:
+		[[nodiscard]] size_t Count() const noexcept
+		{
+			return _count;
+		}
+
+	protected:
+		std::streamsize xsputn(const char*, std::streamsize count) override
+		{
+			_count += static_cast<size_t>(count);
+			return count;
+		}
+
+		int_type overflow(int_type c) override
+		{
+			_count++;
+			return traits_type::not_eof(c);
+		}
+
+	private:
+		size_t _count{ 0 };
+	};
+
+	// a huge pattern goes into HashLife through the mapped file, and is written back out the way it would be saved
+	int RunMacrocell(const std::string& path)
+	{
+		HashLife life;
+		const auto loadStart = std::chrono::steady_clock::now();
+		if (!life.LoadMacrocell(std::filesystem::path{ path }))
+		{
+			std::printf("%s isn't a macrocell pattern HashLife can run\n", path.c_str());
+			return 1;
+		}
+		const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+		const double bytes = static_cast<double>(std::filesystem::file_size(path));
+
+		CountingBuffer buffer;
+		std::ostream stream(&buffer);
+		const auto saveStart = std::chrono::steady_clock::now();
+		life.SaveMacrocell(stream);
+		const double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - saveStart).count();
+
+		std::printf("macrocell    %s, generation %llu\n", path.c_str(), static_cast<unsigned long long>(life.Generation()));
+		std::printf("population   %llu in %zu nodes, %.1f MB\n", static_cast<unsigned long long>(life.Population()), life.NodeCount(), life.MemoryUsage() / 1048576.0);
+		std::printf("load         %.3f s, %.1f MB/s\n", loadSeconds, bytes / loadSeconds / 1e6);
+		std::printf("save         %.3f s, %zu bytes, %.1f MB/s\n", saveSeconds, buffer.Count(), static_cast<double>(buffer.Count()) / saveSeconds / 1e6);
+		return 0;
+	}
+
+	double Microseconds(std::chrono::nanoseconds time, uint64_t generations)
+	{
+		return std::chrono::duration<double, std::micro>(time).count() / static_cast<double>(generations);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		Usage();
+		return 1;
+	}
+
+	if (!options.macrocell.empty())
+	{
+		return RunMacrocell(options.macrocell);
+	}
+
+	bool fastConway = false;
+	Rule rule;
+	if (!ParseRule(options.rule, fastConway, rule))
+	{
+		std::printf("unknown rule %s\n", options.rule.c_str());
+		Usage();
+		return 1;
+	}
+
+	std::string patternPath{ options.pattern };
+	Shape shape(patternPath);
+	if (!options.pattern.empty())
+	{
+		if (!LoadPattern(options.pattern, shape))
+		{
+			return 1;
+		}
+		if (!options.ruleGiven && !shape.RuleText().empty())
+		{
+			if (!Rule::Parse(shape.RuleText(), rule))
+			{
+				std::printf("unknown rule %s in the pattern\n", shape.RuleText().c_str());
+				return 1;
+			}
+			fastConway = false;
+		}
+
+		// the board grows to fit the pattern with a margin on every side
+		options.width = static_cast<uint16_t>(std::clamp(static_cast<int>(shape.Width()) * 2, static_cast<int>(options.width), 65535));
+		options.height = static_cast<uint16_t>(std::clamp(static_cast<int>(shape.Height()) * 2, static_cast<int>(options.height), 65535));
+	}
+
+	Topology topology = Topology::Torus;
+	if (!ParseTopology(options.topology, topology))
+	{
+		std::printf("unknown topology %s\n", options.topology.c_str());
+		Usage();
+		return 1;
+	}
+
+	CycleAction cycles = CycleAction::Off;
+	if (!ParseCycleAction(options.cycles, cycles))
+	{
+		std::printf("unknown cycle action %s\n", options.cycles.c_str());
+		Usage();
+		return 1;
+	}
+
+	Board board;
+	board.SetTopology(topology);
+	board.CycleDetection(cycles);
+	board.HashTracking(options.hash);
+	board.RewindMemory(static_cast<size_t>(std::max(options.rewind, 0)) << 20);
+	if (options.threads > 0)
+	{
+		board.ThreadCount(options.threads);
+	}
+	board.IncrementalNeighbors(options.incremental);
+	board.TemporalBlock(static_cast<uint16_t>(std::clamp(options.block, 1, static_cast<int>(Board::MaxTemporalBlock))));
+	board.Resize(options.width, options.height, 100);
+	if (options.pattern.empty())
+	{
+		FillBoard(board, options.density, options.seed);
+	}
+	else
+	{
+		board.CopyShape(shape, static_cast<uint16_t>((board.Width() - shape.Width()) / 2), static_cast<uint16_t>((board.Height() - shape.Height()) / 2));
+	}
+
+	// FastConway on the torus runs on the bits one generation at a time, everything else can run blocks of generations
+	const bool bitwise = fastConway && topology == Topology::Torus;
+	const auto run = [&](int generations)
+		{
+			if (!bitwise)
+			{
+				board.Update(rule, static_cast<uint32_t>(generations));
+				return;
+			}
+
+			for (int g = 0; g < generations; g++)
+			{
+				board.Update(BoardRules::FastConway);
+			}
+		};
+
+	run(options.warmup);
+	board.ResetPhaseTimes();
+
+	const auto start = std::chrono::steady_clock::now();
+	run(options.generations);
+	const auto end = std::chrono::steady_clock::now();
+
+	const double seconds = std::chrono::duration<double>(end - start).count();
+	const double generationsPerSecond = options.generations / seconds;
+	const double cellsPerSecond = generationsPerSecond * board.Size();
+	const PhaseTimes& phases = board.GetPhaseTimes();
+
+	std::printf("board        %ux%u\n", board.Width(), board.Height());
+	std::printf("rule         %s%s%s\n", rule.ToString().c_str(), bitwise ? " (bitwise)" : "", (options.incremental && !bitwise && !rule.IsGenerations()) ? " (incremental)" : "");
+	std::printf("topology     %s\n", options.topology.c_str());
+	std::printf("block        %u generations\n", board.TemporalBlock());
+	if (options.pattern.empty())
+	{
+		std::printf("density      %.3f seed %llu\n", options.density, static_cast<unsigned long long>(options.seed));
+	}
+	std::printf("threads      %d\n", board.ThreadCount());
+	std::printf("generations  %d in %.3f s (%d warmup)\n", options.generations, seconds, options.warmup);
+	std::printf("gens/sec     %.1f\n", generationsPerSecond);
+	std::printf("cells/sec    %.3e\n", cellsPerSecond);
+	std::printf("per generation (us): prepare %.2f  step (count + rule + apply) %.2f  publish %.2f\n",
+		Microseconds(phases.prepare, phases.generations),
+		Microseconds(phases.step, phases.generations),
+		Microseconds(phases.publish, phases.generations));
+	std::printf("live cells   %u\n", board.GetLiveCount());
+	if (options.rewind > 0)
+	{
+		// seek to the oldest remembered generation, the middle one and back to the newest
+		const uint32_t oldest = board.OldestGeneration();
+		const uint32_t newest = board.NewestGeneration();
+		double slowest = 0.0;
+		for (const uint32_t generation : { oldest, oldest + ((newest - oldest) / 2), newest })
+		{
+			const auto seekStart = std::chrono::steady_clock::now();
+			board.SeekGeneration(generation);
+			slowest = std::max(slowest, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - seekStart).count());
+		}
+		std::printf("rewind       generations %u to %u in %.1f MB, slowest seek %.2f ms\n", oldest, newest, board.RewindMemoryUsed() / 1048576.0, slowest);
+	}
+	if (options.hash)
+	{
+		std::printf("hash         %016llx (tracked)\n", static_cast<unsigned long long>(board.Hash()));
+	}
+	if (const CycleInfo cycle = board.GetCycle(); cycle.period != 0)
+	{
+		std::printf("cycle        period %u from generation %u (%s)%s\n", cycle.period, cycle.start, options.cycles.c_str(), board.IsPaused() ? ", paused" : "");
+	}
+	else if (cycles != CycleAction::Off)
+	{
+		std::printf("cycle        none found in %u generations\n", board.Generation());
+	}
+	return 0;
+}
@@ -0,0 +1,212 @@
+// Checks macrocell (.mc) patterns through HashLife and Shape, written and read back, returns non-zero if any check fails.
+//
+// usage: MacrocellTest
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "Board.h"
+#include "HashLife.h"
+#include "Shape.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const std::string& what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	std::string path{ "test" };
+
+	[[nodiscard]] std::string Save(const HashLife& life)
+	{
+		std::ostringstream stream;
+		Check(life.SaveMacrocell(stream), "the universe is written");
+		return stream.str();
+	}
+
+	// the shape is the board's live cells, cut to the box around them
+	[[nodiscard]] bool ShapeIsBoard(Shape& shape, const Board& board)
+	{
+		uint16_t left = board.Width();
+		uint16_t top = board.Height();
+		uint16_t right = 0;
+		uint16_t bottom = 0;
+		for (uint16_t y = 0; y < board.Height(); y++)
+		{
+			for (uint16_t x = 0; x < board.Width(); x++)
+			{
+				if (board.Alive(x, y))
+				{
+					left = std::min(left, x);
+					top = std::min(top, y);
+					right = std::max(right, gsl::narrow_cast<uint16_t>(x + 1));
+					bottom = std::max(bottom, gsl::narrow_cast<uint16_t>(y + 1));
+				}
+			}
+		}
+		if (shape.Width() != right - left || shape.Height() != bottom - top)
+		{
+			return false;
+		}
+		for (uint16_t y = 0; y < shape.Height(); y++)
+		{
+			for (uint16_t x = 0; x < shape.Width(); x++)
+			{
+				if (shape.IsAlive(x, y) != board.Alive(x + left, y + top))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]] uint32_t Differences(const Board& a, const Board& b)
+	{
+		uint32_t differences = 0;
+		for (uint16_t y = 0; y < a.Height(); y++)
+		{
+			for (uint16_t x = 0; x < a.Width(); x++)
+			{
+				differences += a.Alive(x, y) != b.Alive(x, y) ? 1 : 0;
+			}
+		}
+		return differences;
+	}
+
+	// a soup on a Board goes into HashLife, out as .mc text and a file, and back into HashLife and a Shape
+	void BoardRoundTrip()
+	{
+		Board board;
+		board.Resize(200, 150, 100);
+		board.RandomizeBoard(0.3f, 100, 3);
+		for (int generation = 0; generation < 10; generation++)
+		{
+			board.Update(BoardRules::Conway);
+		}
+
+		HashLife life;
+		life.LoadBoard(board);
+		Check(life.Population() == board.GetLiveCount() && life.Generation() == 10, "HashLife takes the board's cells and generation");
+
+		const std::string text = Save(life);
+		Check(text.starts_with("[M2]") && text.find("#R B3/S23\n") != std::string::npos && text.find("#G 10\n") != std::string::npos, "the file has the header, rule and generation");
+
+		Shape shape(path);
+		Check(shape.Load(std::string_view{ text }) && shape.GetFormat() == Shape::Format::Macrocell, "the file loads as a shape");
+		Check(shape.GetLiveCount() == board.GetLiveCount() && ShapeIsBoard(shape, board), "the shape has the board's cells");
+		Check(shape.RuleText() == "B3/S23", "the shape takes the rule");
+
+		// the board's top left cell is at the root's top left corner, 256 cells across
+		HashLife loaded;
+		Check(loaded.LoadMacrocell(std::string_view{ text }), "the file loads into HashLife");
+		Check(loaded.Population() == board.GetLiveCount() && loaded.Generation() == 10, "HashLife takes the population and generation back");
+		Board copy;
+		copy.Resize(200, 150, 100);
+		loaded.CopyToBoard(copy, -128, -128);
+		Check(Differences(board, copy) == 0, "HashLife has the board's cells where it put them");
+		Check(Save(loaded) == text, "writing it again gives the same file");
+
+		// and through a file, which is mapped
+		std::filesystem::path file = std::filesystem::temp_directory_path() / "MacrocellTest.mc";
+		{
+			std::ofstream stream(file, std::ios::binary);
+			Check(life.SaveMacrocell(stream), "the universe is written to a file");
+		}
+		HashLife mapped;
+		Check(mapped.LoadMacrocell(file) && mapped.Population() == board.GetLiveCount(), "the file loads into HashLife from disk");
+		Shape fromFile(file);
+		Check(fromFile.Load() && ShapeIsBoard(fromFile, board), "the file loads as a shape from disk");
+		std::filesystem::remove(file);
+	}
+
+	// a file that's one leaf, and one built from level 1 nodes
+	void SmallFiles()
+	{
+		const std::string_view leaf{ "[M2] (test)\n#R B3/S23\n.*$..*$***$\n" };
+		Shape glider(path);
+		Check(glider.Load(leaf) && glider.Width() == 3 && glider.Height() == 3 && glider.GetLiveCount() == 5, "a leaf loads as a 3x3 shape");
+		Check(glider.IsAlive(1, 0) && glider.IsAlive(2, 1) && glider.IsAlive(0, 2) && glider.IsAlive(1, 2) && glider.IsAlive(2, 2), "the leaf's rows go down the shape");
+
+		// the leaf is the root, 8 cells across from -4
+		HashLife life;
+		Check(life.LoadMacrocell(leaf) && life.Population() == 5, "a leaf loads into HashLife");
+		Check(life.GetCell(-3, -4) && life.GetCell(-2, -3) && life.GetCell(-4, -2) && !life.GetCell(-4, -4), "the leaf's cells are around the center");
+
+		// a level 2 node made of two level 1 nodes, each with its nw and se cells alive
+		const std::string_view level1{ "[M2] (test)\n#R B3/S23\n1 1 0 0 1\n2 1 1 0 0\n" };
+		Shape pairs(path);
+		Check(pairs.Load(level1) && pairs.Width() == 4 && pairs.Height() == 2 && pairs.GetLiveCount() == 4, "level 1 nodes load as a 4x2 shape");
+		Check(pairs.IsAlive(0, 0) && pairs.IsAlive(1, 1) && pairs.IsAlive(2, 0) && pairs.IsAlive(3, 1), "the level 1 cells are where their nodes are");
+		Check(life.LoadMacrocell(level1) && life.Population() == 4 && life.GetCell(-2, -2) && life.GetCell(1, -1), "level 1 nodes load into HashLife");
+
+		// the level 1 form is for rules with more states, which a shape reads as alive and HashLife can't run
+		const std::string_view states{ "[M2] (test)\n#R B2/S/C3\n1 1 2 0 1\n" };
+		Shape brain(path);
+		Check(brain.Load(states) && brain.GetLiveCount() == 3 && brain.RuleText() == "B2/S/C3", "a Generations file loads as a shape");
+		Check(!life.LoadMacrocell(states) && life.Population() == 0, "HashLife turns down a Generations rule");
+	}
+
+	void Malformed()
+	{
+		const auto rejected = [](std::string_view text, const char* what)
+			{
+				Shape shape(path);
+				HashLife life;
+				Check(!shape.Load(text), std::string{ "a shape turns down " } + what);
+				Check(!life.LoadMacrocell(text) && life.Population() == 0, std::string{ "HashLife turns down " } + what);
+			};
+
+		rejected("[M2] (test)\n.*$\n4 1 0 0 3\n", "a child line past the current line");
+		rejected("[M2] (test)\n.*$\n4 2 0 0 0\n", "a node that is its own child");
+		rejected("[M2] (test)\n.*$\n5 1 0 0 0\n", "a child at the wrong level");
+		rejected("[M2] (test)\n1 1 0 0 1\n4 1 0 0 0\n", "a level 1 child of a level 4 node");
+		rejected("[M2] (test)\n.*$\n4 1 x 0 0\n", "a child that isn't a number");
+		rejected("[M2] (test)\n#G ten\n.*$\n", "a generation that isn't a number");
+
+		// a shape reads other formats too, HashLife only this one
+		HashLife life;
+		Check(!life.LoadMacrocell(std::string_view{ "x = 3, y = 3\nbob$2bo$3o!\n" }), "HashLife turns down RLE");
+	}
+
+	// #R and #G come through a load and a save
+	void HeadersCarried()
+	{
+		const std::string_view text{ "[M2] (test)\n#R B36/S23\n#G 1000\n.*$..*$***$\n" };
+		HashLife life;
+		Check(life.LoadMacrocell(text) && life.Generation() == 1000, "HashLife takes the generation from #G");
+
+		const std::string saved = Save(life);
+		Check(saved.find("#R B36/S23\n") != std::string::npos, "the rule from #R is written back");
+		Check(saved.find("#G 1000\n") != std::string::npos, "the generation from #G is written back");
+
+		life.AdvanceBy(4);
+		Check(Save(life).find("#G 1004\n") != std::string::npos, "the generation counts on from #G");
+
+		Shape shape(path);
+		Check(shape.Load(text) && shape.RuleText() == "B36/S23", "a shape takes the rule from #R");
+	}
+}
+
+int main()
+{
+	BoardRoundTrip();
+	SmallFiles();
+	Malformed();
+	HeadersCarried();
+
+	std::printf("%s\n", failures == 0 ? "all macrocell checks passed" : "macrocell checks failed");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+// Microbenchmarks for the pieces a generation is made of: the rule tables, neighbor counting,
+// the per-row step, the board hash and RandomizeBoard, over board sizes from 25x25 to 4096x4096 and densities from 1% to 90%.
+// Every benchmark reports items_per_second, where an item is one cell.
+//
+// usage: MicroBench [--benchmark_filter=regex] [--benchmark_out=results.json --benchmark_out_format=json]
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Board.h"
+#include "BenchBoard.h"
+#include "GenerationsBitBoard.h"
+#include "NeighborKernel.h"
+
+// reaches the private per-cell functions Board calls from Update
+struct BoardBenchAccess
+{
+	static void CountLiveAndDyingNeighbors(Board& board, uint16_t x, uint16_t y)
+	{
+		board.CountLiveAndDyingNeighbors(x, y);
+	}
+
+	static uint8_t CountLiveNotDyingNeighbors(Board& board, uint16_t x, uint16_t y)
+	{
+		return board.CountLiveNotDyingNeighbors(x, y);
+	}
+
+	// every tile active, as after an edit
+	static void PrepareRows(Board& board)
+	{
+		board.InvalidateDerived();
+		board.FillAliveRows(0, board.Height());
+		board.FillHalo();
+		board.FindActiveTiles();
+	}
+
+	static void UpdateRowsWithNextState(Board& board, const Rule& rule, GenerationCounts& counts, uint64_t& hash)
+	{
+		board.UpdateRowsWithNextState(0, board.Height(), rule, counts, hash);
+	}
+};
+
+namespace
+{
+	constexpr uint64_t Seed{ 1 };
+
+	// args are { board side, live cells in percent }
+	void Sizes(benchmark::internal::Benchmark* bench)
+	{
+		bench->ArgNames({ "size", "density" });
+		bench->ArgsProduct({ { 25, 256, 1024, 4096 }, { 1, 10, 30, 50, 90 } });
+		bench->Unit(benchmark::kMicrosecond);
+	}
+
+	uint16_t Side(const benchmark::State& state)
+	{
+		return static_cast<uint16_t>(state.range(0));
+	}
+
+	double Density(const benchmark::State& state)
+	{
+		return static_cast<double>(state.range(1)) / 100.0;
+	}
+
+	void MakeBoard(Board& board, const benchmark::State& state)
+	{
+		board.Resize(Side(state), Side(state), 100);
+		FillBoard(board, Density(state), Seed);
+	}
+
+	void CountCells(benchmark::State& state, uint64_t cellsPerIteration)
+	{
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cellsPerIteration));
+	}
+
+	// one full generation through Board::Update for each built-in ruleset
+	void BM_Update(benchmark::State& state, BoardRules rules)
+	{
+		Board board;
+		MakeBoard(board, state);
+
+		for (auto _ : state)
+		{
+			board.Update(rules);
+		}
+		CountCells(state, board.Size());
+	}
+
+	// Conway's rule 8 generations at a time per block, an item is one cell for one generation
+	void BM_UpdateBlocked(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+		board.TemporalBlock(8);
+		const Rule rule = Rule::Preset(BoardRules::Conway);
+
+		for (auto _ : state)
+		{
+			board.Update(rule, 8);
+		}
+		CountCells(state, uint64_t{ board.Size() } * 8);
+	}
+
+	// Conway's rule with the Zobrist hash kept up to date or not, the difference is what the upkeep costs
+	void BM_UpdateHash(benchmark::State& state, bool tracked)
+	{
+		Board board;
+		MakeBoard(board, state);
+		board.HashTracking(tracked);
+		const Rule rule = Rule::Preset(BoardRules::Conway);
+
+		for (auto _ : state)
+		{
+			board.Update(rule);
+			if (tracked)
+			{
+				benchmark::DoNotOptimize(board.Hash());
+			}
+		}
+		CountCells(state, board.Size());
+	}
+
+	// the hash from scratch, what Hash costs when it isn't tracked
+	void BM_ComputeHash(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(board.ComputeHash());
+		}
+		CountCells(state, board.Size());
+	}
+
+	// the rule table on its own: the next state of every cell from its alive byte and neighbor count
+	void BM_RuleTable(benchmark::State& state, BoardRules rules)
+	{
+		Board board;
+		MakeBoard(board, state);
+		const Rule rule = Rule::Preset(rules);
+
+		std::vector<uint8_t> alive(board.Size());
+		std::vector<uint8_t> neighbors(board.Size());
+		for (uint16_t y = 0; y < board.Height(); y++)
+		{
+			for (uint16_t x = 0; x < board.Width(); x++)
+			{
+				const size_t i = static_cast<size_t>(y) * board.Width() + x;
+				alive[i] = board.Alive(x, y) ? 1 : 0;
+				neighbors[i] = BoardBenchAccess::CountLiveNotDyingNeighbors(board, x, y);
+			}
+		}
+
+		std::vector<Cell::State> next(board.Size());
+		for (auto _ : state)
+		{
+			for (size_t i = 0; i < next.size(); i++)
+			{
+				next[i] = rule.NextState(alive[i], neighbors[i]);
+			}
+			benchmark::DoNotOptimize(next.data());
+			benchmark::ClobberMemory();
+		}
+		CountCells(state, board.Size());
+	}
+
+	// Brian's Brain on the bit planes, the Generations path
+	void BM_GenerationsStepRows(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+		const Rule rule = Rule::Preset(BoardRules::BriansBrain);
+
+		GenerationsBitBoard planes;
+		planes.Resize(board.Width(), board.Height(), rule.States());
+		for (uint16_t y = 0; y < board.Height(); y++)
+		{
+			for (uint16_t x = 0; x < board.Width(); x++)
+			{
+				planes.Set(x, y, board.Alive(x, y) ? 1 : 0);
+			}
+		}
+
+		for (auto _ : state)
+		{
+			planes.StepRows(0, board.Height(), rule);
+			planes.Swap();
+		}
+		CountCells(state, board.Size());
+	}
+
+	// reads the alive bytes and their halo
+	void BM_CountLiveAndDyingNeighbors(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+		BoardBenchAccess::PrepareRows(board);
+
+		for (auto _ : state)
+		{
+			for (uint16_t y = 0; y < board.Height(); y++)
+			{
+				for (uint16_t x = 0; x < board.Width(); x++)
+				{
+					BoardBenchAccess::CountLiveAndDyingNeighbors(board, x, y);
+				}
+			}
+			benchmark::ClobberMemory();
+		}
+		CountCells(state, board.Size());
+	}
+
+	void BM_CountLiveNotDyingNeighbors(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+
+		for (auto _ : state)
+		{
+			for (uint16_t y = 0; y < board.Height(); y++)
+			{
+				for (uint16_t x = 0; x < board.Width(); x++)
+				{
+					benchmark::DoNotOptimize(BoardBenchAccess::CountLiveNotDyingNeighbors(board, x, y));
+				}
+			}
+		}
+		CountCells(state, board.Size());
+	}
+
+	// the byte-per-cell neighbor count Update uses, on each path the CPU can run
+	void BM_NeighborKernel(benchmark::State& state, NeighborKernel::Path path)
+	{
+		const NeighborKernel kernel(path);
+		if (kernel.GetPath() != path)
+		{
+			state.SkipWithError("path not supported on this CPU");
+			return;
+		}
+
+		Board board;
+		MakeBoard(board, state);
+		const uint16_t width = board.Width();
+		const uint16_t height = board.Height();
+
+		std::vector<uint8_t> alive(board.Size());
+		for (uint16_t y = 0; y < height; y++)
+		{
+			for (uint16_t x = 0; x < width; x++)
+			{
+				alive[static_cast<size_t>(y) * width + x] = board.Alive(x, y) ? 1 : 0;
+			}
+		}
+
+		std::vector<uint8_t> counts(width);
+		for (auto _ : state)
+		{
+			for (uint16_t y = 0; y < height; y++)
+			{
+				const uint16_t yabove = (y == 0) ? height - 1 : y - 1;
+				const uint16_t ybelow = (y == height - 1) ? 0 : y + 1;
+				kernel.CountRow(&alive[static_cast<size_t>(yabove) * width], &alive[static_cast<size_t>(y) * width], &alive[static_cast<size_t>(ybelow) * width], counts.data(), width);
+				benchmark::DoNotOptimize(counts.data());
+			}
+		}
+		CountCells(state, board.Size());
+	}
+
+	// counts, applies Conway's rule table and writes the next generation of every row on one thread,
+	// the work Update splits between threads; it reads the same generation every iteration
+	void BM_UpdateRowsWithNextState(benchmark::State& state)
+	{
+		Board board;
+		MakeBoard(board, state);
+		const Rule rule = Rule::Preset(BoardRules::Conway);
+		BoardBenchAccess::PrepareRows(board);
+
+		for (auto _ : state)
+		{
+			GenerationCounts counts;
+			uint64_t hash = 0;
+			BoardBenchAccess::UpdateRowsWithNextState(board, rule, counts, hash);
+			benchmark::DoNotOptimize(counts);
+			benchmark::DoNotOptimize(hash);
+			benchmark::ClobberMemory();
+		}
+		CountCells(state, board.Size());
+	}
+
+	void BM_RandomizeBoard(benchmark::State& state)
+	{
+		Board board;
+		board.Resize(Side(state), Side(state), 100);
+		const float alivepct = static_cast<float>(Density(state));
+
+		for (auto _ : state)
+		{
+			board.RandomizeBoard(alivepct, 100, Seed);
+		}
+		CountCells(state, board.Size());
+	}
+}
+
+BENCHMARK_CAPTURE(BM_Update, FastConway, BoardRules::FastConway)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, Conway, BoardRules::Conway)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, DayAndNight, BoardRules::DayAndNight)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, LifeWithoutDeath, BoardRules::LifeWithoutDeath)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, BriansBrain, BoardRules::BriansBrain)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, Seeds, BoardRules::Seeds)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_Update, Highlife, BoardRules::Highlife)->Apply(Sizes);
+
+BENCHMARK(BM_UpdateBlocked)->Apply(Sizes);
+
+BENCHMARK_CAPTURE(BM_UpdateHash, Untracked, false)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_UpdateHash, Tracked, true)->Apply(Sizes);
+BENCHMARK(BM_ComputeHash)->Apply(Sizes);
+
+BENCHMARK_CAPTURE(BM_RuleTable, Conway, BoardRules::Conway)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_RuleTable, DayAndNight, BoardRules::DayAndNight)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_RuleTable, LifeWithoutDeath, BoardRules::LifeWithoutDeath)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_RuleTable, Seeds, BoardRules::Seeds)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_RuleTable, Highlife, BoardRules::Highlife)->Apply(Sizes);
+
+BENCHMARK(BM_GenerationsStepRows)->Apply(Sizes);
+
+BENCHMARK(BM_CountLiveAndDyingNeighbors)->Apply(Sizes);
+BENCHMARK(BM_CountLiveNotDyingNeighbors)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_NeighborKernel, Scalar, NeighborKernel::Path::Scalar)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_NeighborKernel, SSE2, NeighborKernel::Path::SSE2)->Apply(Sizes);
+BENCHMARK_CAPTURE(BM_NeighborKernel, AVX2, NeighborKernel::Path::AVX2)->Apply(Sizes);
+
+BENCHMARK(BM_UpdateRowsWithNextState)->Apply(Sizes);
+BENCHMARK(BM_RandomizeBoard)->Apply(Sizes);
+
+BENCHMARK_MAIN();
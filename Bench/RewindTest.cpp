@@ -0,0 +1,82 @@
+// Checks that a rewound board replays the same future as one that never went back, returns non-zero if any check fails.
+//
+// usage: RewindTest
+
+#include <cstdio>
+#include <string>
+
+#include "Board.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const std::string& what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	void Run(Board& board, const Rule& rule, int generations)
+	{
+		for (int generation = 0; generation < generations; generation++)
+		{
+			board.Update(rule);
+		}
+	}
+
+	[[nodiscard]] uint32_t Differences(const Board& a, const Board& b)
+	{
+		uint32_t differences = 0;
+		for (uint16_t y = 0; y < a.Height(); y++)
+		{
+			for (uint16_t x = 0; x < a.Width(); x++)
+			{
+				differences += a.GetCell(x, y).GetState() != b.GetCell(x, y).GetState() ? 1 : 0;
+			}
+		}
+		return differences;
+	}
+
+	// 20 generations, back 5 and forward again, then 20 more, against a board that ran 40 straight
+	// frames only hold Cell states, so a Generations rule past C3 needs the decay stages brought back too
+	void RewindReplaysTheSameFuture(const char* text)
+	{
+		Rule rule;
+		Check(Rule::Parse(text, rule), std::string{ text } + " parses");
+
+		Board board;
+		Board rewound;
+		for (Board* b : { &board, &rewound })
+		{
+			b->Resize(64, 64, 100);
+			b->RandomizeBoard(0.3f, 100, 11);
+			b->RewindMemory(size_t{ 16 } << 20);
+			b->RewindKeyframes(4);
+			Run(*b, rule, 20);
+		}
+
+		Check(rewound.Rewind(5) && rewound.Generation() == 15, std::string{ "the board goes back 5 generations under " } + text);
+		Run(rewound, rule, 5);
+		Check(Differences(board, rewound) == 0, std::string{ "the generation it comes back to is the same under " } + text);
+
+		Run(board, rule, 20);
+		Run(rewound, rule, 20);
+		Check(rewound.Generation() == 40 && board.GetLiveCount() == rewound.GetLiveCount(), std::string{ "the counts match 20 generations on under " } + text);
+		Check(Differences(board, rewound) == 0, std::string{ "the board matches 20 generations on under " } + text);
+	}
+}
+
+int main()
+{
+	RewindReplaysTheSameFuture("B3/S23");
+	RewindReplaysTheSameFuture("B3/S23/C3");
+	RewindReplaysTheSameFuture("B3/S23/C6");
+	RewindReplaysTheSameFuture("B2/S345/C4");
+
+	std::printf("%s\n", failures == 0 ? "all rewind checks passed" : "rewind checks failed");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Checks the pattern parser on RLE, Life 1.06 and plaintext, from text and from streams, returns non-zero if any check fails.
+//
+// usage: ShapeTest
+
+#include <cstdio>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "Shape.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const std::string& what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	// the shape has exactly these live cells
+	[[nodiscard]] bool Cells(Shape& shape, std::initializer_list<std::pair<uint16_t, uint16_t>> live)
+	{
+		if (shape.GetLiveCount() != live.size())
+		{
+			return false;
+		}
+		for (const auto& [x, y] : live)
+		{
+			if (x >= shape.Width() || y >= shape.Height() || !shape.IsAlive(x, y))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]] bool Same(Shape& a, Shape& b)
+	{
+		if (a.Width() != b.Width() || a.Height() != b.Height() || a.GetLiveCount() != b.GetLiveCount())
+		{
+			return false;
+		}
+		for (uint16_t y = 0; y < a.Height(); y++)
+		{
+			for (uint16_t x = 0; x < a.Width(); x++)
+			{
+				if (a.IsAlive(x, y) != b.IsAlive(x, y))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	std::string path{ "test" };
+
+	void RleGlider()
+	{
+		Shape shape(path);
+		Check(shape.Load(std::string_view{ "#N Glider\n#C a note\nx = 3, y = 3, rule = B3/S23\nbob$2bo$3o!\n" }), "an RLE glider loads");
+		Check(shape.GetFormat() == Shape::Format::RLE && shape.Width() == 3 && shape.Height() == 3, "the RLE glider is 3x3 RLE");
+		Check(Cells(shape, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "the RLE glider has its cells");
+		Check(shape.RuleText() == "B3/S23", "the rule comes from the header");
+		Check(shape.GetNotes().size() == 2 && shape.GetNotes()[1] == "#C a note", "the comments are kept as notes");
+
+		Check(shape.Load(std::string_view{ "x = 3, y = 3, rule = B3/S23:T10,10\nbob$2bo$3o!" }), "an RLE glider on a bounded grid loads");
+		Check(shape.RuleText() == "B3/S23:T10,10", "a rule with a comma is read to the end of the line");
+		Check(Cells(shape, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "the header's last field doesn't change the cells");
+	}
+
+	// runs of more than 9, runs of rows, and rows past the height the header gives, which are left out
+	void RleRuns()
+	{
+		Shape shape(path);
+		Check(shape.Load(std::string_view{ "x = 70, y = 4\n12b58o$\n3$70o!" }), "multi-digit runs load");
+		Check(shape.Width() == 70 && shape.Height() == 4 && shape.GetLiveCount() == 58, "a run of 58 crosses a 64 bit word");
+		Check(!shape.IsAlive(11, 0) && shape.IsAlive(12, 0) && shape.IsAlive(63, 0) && shape.IsAlive(64, 0) && shape.IsAlive(69, 0), "the run starts after 12 dead cells");
+		Check(!shape.IsAlive(0, 3), "rows past the height are left out");
+
+		Check(shape.Load(std::string_view{ "x = 2, y = 2\n2o$o2$10$4o!" }), "a $ run past the height loads");
+		Check(Cells(shape, { { 0, 0 }, { 1, 0 }, { 0, 1 } }), "the cells past the height and width are left out");
+	}
+
+	void CrLf()
+	{
+		Shape rle(path);
+		Check(rle.Load(std::string_view{ "#N Glider\r\nx = 3, y = 3, rule = B3/S23\r\nbob$2bo$\r\n3o!\r\n" }), "RLE with \\r\\n loads");
+		Check(rle.RuleText() == "B3/S23" && rle.GetNotes()[0] == "#N Glider", "\\r isn't kept in the header or the notes");
+		Check(Cells(rle, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "the RLE glider with \\r\\n has its cells");
+
+		Shape cells(path);
+		Check(cells.Load(std::string_view{ "!Name: Glider\r\n.O.\r\n..O\r\nOOO\r\n" }), ".cells with \\r\\n loads");
+		Check(cells.Width() == 3 && cells.Height() == 3 && Cells(cells, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "\\r isn't a cell");
+	}
+
+	// the same glider after comments long enough to put the block boundary in every part of the header and the body
+	void StreamAcrossBlocks()
+	{
+		const std::string_view pattern{ "x = 12, y = 3, rule = B3/S23\nb11o$2bo$3o!\n" };
+		constexpr size_t Block{ size_t{ 1 } << 16 };
+
+		Shape whole(path);
+		Check(whole.Load(pattern), "the pattern loads on its own");
+
+		for (size_t split = 0; split <= pattern.size(); split++)
+		{
+			// each comment line is the note, its newline and padding, and ends where the pattern should start
+			std::string text;
+			while (text.size() + 4096 < Block - split)
+			{
+				text += "#C " + std::string(4092, 'a') + "\n";
+			}
+			text += "#C " + std::string(Block - split - text.size() - 4, 'b') + "\n";
+			text += pattern;
+
+			std::istringstream stream(text);
+			Shape shape(path);
+			const std::string at = " with the block boundary " + std::to_string(split) + " characters into the pattern";
+			Check(shape.Load(stream), "the stream loads" + at);
+			Check(Same(shape, whole) && shape.RuleText() == "B3/S23", "the stream reads the same pattern" + at);
+		}
+
+		// a long file in a stream reads the same as it does as text
+		std::string text{ "#Life 1.06\n" };
+		for (int i = 0; i < 20000; i++)
+		{
+			text += std::to_string((i * 37) % 1000 - 500) + " " + std::to_string((i * 91) % 700 - 350) + "\n";
+		}
+		std::istringstream stream(text);
+		Shape streamed(path);
+		Shape loaded(path);
+		Check(streamed.Load(stream) && loaded.Load(std::string_view{ text }), "a long Life 1.06 file loads from a stream and from text");
+		Check(text.size() > 2 * Block && Same(streamed, loaded), "a long Life 1.06 file reads the same from a stream and from text");
+	}
+
+	void Life106()
+	{
+		Shape shape(path);
+		Check(shape.Load(std::string_view{ "#Life 1.06\n#D a glider\n0 -1\n1 0\n-1 1\n0 1\n1 1" }), "Life 1.06 loads");
+		Check(shape.GetFormat() == Shape::Format::Life106 && shape.Width() == 3 && shape.Height() == 3, "the Life 1.06 glider is 3x3");
+		Check(Cells(shape, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "negative coordinates are moved to the top left");
+
+		Check(!shape.Load(std::string_view{ "#Life 1.06\n1 2 3\n" }), "three coordinates on a line are rejected");
+		Check(!shape.Load(std::string_view{ "#Life 1.05\n*.*\n" }), "Life 1.05 is rejected");
+	}
+
+	void Plaintext()
+	{
+		Shape shape(path);
+		Check(shape.Load(std::string_view{ "!Name: Glider\n!\n.O\n..O\nOOO" }), ".cells loads");
+		Check(shape.GetFormat() == Shape::Format::Plaintext && shape.Width() == 3 && shape.Height() == 3, "the widest row sets the width");
+		Check(Cells(shape, { { 1, 0 }, { 2, 1 }, { 0, 2 }, { 1, 2 }, { 2, 2 } }), "the .cells glider has its cells");
+		Check(shape.GetNotes()[0] == "!Name: Glider", "the name line is a note");
+	}
+
+	void Rejected()
+	{
+		Shape shape(path);
+		Check(!shape.Load(std::string_view{}), "empty text is rejected");
+		std::istringstream empty;
+		Check(!shape.Load(empty), "an empty stream is rejected");
+		Check(!shape.Load(std::string_view{ "hello, world\n" }), "text that isn't a pattern is rejected");
+		Check(!shape.Load(std::string_view{ "x = 3\nbo!" }), "an RLE header without y is rejected");
+		Check(!shape.Load(std::string_view{ "x = 3, y = 3\nb%o!" }), "a character RLE doesn't have is rejected");
+		Check(!shape.Load(std::string_view{ "x = 70000, y = 1\no!" }), "a pattern over 65535 cells across is rejected");
+		Check(shape.Width() == 0 && shape.Height() == 0 && shape.GetLiveCount() == 0, "a rejected pattern leaves an empty shape");
+	}
+}
+
+int main()
+{
+	RleGlider();
+	RleRuns();
+	CrLf();
+	StreamAcrossBlocks();
+	Life106();
+	Plaintext();
+	Rejected();
+
+	std::printf("%s\n", failures == 0 ? "all shape checks passed" : "shape checks failed");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// Checks SparseBoard against Board on patterns that cross chunk edges and negative coordinates,
+// returns non-zero if any check fails.
+//
+// usage: SparseTest
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "Board.h"
+#include "SparseBoard.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const std::string& what)
+	{
+		if (!passed)
+		{
+			std::printf("FAILED: %s\n", what.c_str());
+			failures++;
+		}
+	}
+
+	// the window of the plane a Board of Extent x Extent stands in for, centered on (0, 0) and far from any wrap
+	constexpr uint16_t Extent{ 512 };
+	constexpr int64_t Origin{ Extent / 2 };
+
+	void SetBoth(SparseBoard& sparse, Board& board, int64_t x, int64_t y)
+	{
+		sparse.SetCell(x, y, true);
+		board.TurnCellOn(GridPoint{ gsl::narrow_cast<uint16_t>(x + Origin), gsl::narrow_cast<uint16_t>(y + Origin) }, true);
+	}
+
+	[[nodiscard]] uint32_t Differences(const SparseBoard& sparse, const Board& board)
+	{
+		Board window;
+		window.Resize(Extent, Extent, 100);
+		sparse.CopyToBoard(window, -Origin, -Origin);
+
+		uint32_t differences = 0;
+		for (uint16_t y = 0; y < Extent; y++)
+		{
+			for (uint16_t x = 0; x < Extent; x++)
+			{
+				differences += window.Alive(x, y) != board.Alive(x, y) ? 1 : 0;
+			}
+		}
+		return differences;
+	}
+
+	void Run(SparseBoard& sparse, Board& board, int generations, const char* name)
+	{
+		const Rule rule = Rule::Preset(BoardRules::Conway);
+		for (int generation = 1; generation <= generations; generation++)
+		{
+			sparse.Update(rule);
+			board.Update(rule);
+			if (sparse.Population() != board.GetLiveCount() || (generation % 25) == 0)
+			{
+				const std::string at = std::string{ name } + " at generation " + std::to_string(generation);
+				Check(sparse.Population() == board.GetLiveCount(), "the population matches Board for the " + at);
+				Check(Differences(sparse, board) == 0, "the cells match Board for the " + at);
+				if (failures > 0)
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	// a glider heading up and left from (0, 0) crosses into chunk -1 and -2 both ways,
+	// and the chunks it leaves behind are freed, so there are never more than the 4 it can touch
+	void GliderCrossesChunks()
+	{
+		SparseBoard sparse;
+		Board board;
+		board.Resize(Extent, Extent, 100);
+		for (const auto& [x, y] : { std::pair{ 1, 1 }, { 2, 1 }, { 3, 1 }, { 1, 2 }, { 2, 3 } })
+		{
+			SetBoth(sparse, board, x, y);
+		}
+		Check(sparse.ChunkCount() == 1, "the glider starts in one chunk");
+
+		const Rule rule = Rule::Preset(BoardRules::Conway);
+		size_t most = 0;
+		for (int generation = 0; generation < 400; generation++)
+		{
+			sparse.Update(rule);
+			board.Update(rule);
+			most = std::max(most, sparse.ChunkCount());
+		}
+		Check(sparse.Generation() == 400 && sparse.Population() == 5, "the glider is still a glider after 400 generations");
+		Check(Differences(sparse, board) == 0, "the glider is where Board has it");
+		Check(sparse.GetCell(-99, -99) && !sparse.GetCell(1, 1), "the glider moved 100 cells up and left");
+		Check(most <= 4, "the chunks a glider leaves are freed");
+		Check(sparse.ChunkCount() == 1, "a glider inside one chunk keeps only that chunk");
+
+		sparse.Clear();
+		Check(sparse.ChunkCount() == 0 && sparse.Population() == 0, "Clear frees every chunk");
+	}
+
+	// an R-pentomino on the corner of 4 chunks spreads across many of them and throws gliders off in every direction
+	void PentominoMatchesBoard()
+	{
+		SparseBoard sparse;
+		Board board;
+		board.Resize(Extent, Extent, 100);
+		for (const auto& [x, y] : { std::pair{ 0, -1 }, { 1, -1 }, { -1, 0 }, { 0, 0 }, { 0, 1 } })
+		{
+			SetBoth(sparse, board, x, y);
+		}
+		Run(sparse, board, 300, "R-pentomino");
+	}
+
+	// the last cell of a chunk going out frees it
+	void EmptyChunksAreFreed()
+	{
+		SparseBoard sparse;
+		sparse.SetCell(-1, -1, true);
+		sparse.SetCell(64, 0, true);
+		Check(sparse.ChunkCount() == 2 && sparse.Population() == 2, "each cell is in its own chunk");
+		sparse.SetCell(-1, -1, false);
+		Check(sparse.ChunkCount() == 1 && sparse.Population() == 1 && !sparse.GetCell(-1, -1), "turning off a chunk's last cell frees it");
+		sparse.Update(Rule::Preset(BoardRules::Conway));
+		Check(sparse.ChunkCount() == 0 && sparse.Population() == 0, "a chunk whose cells all die is freed");
+	}
+}
+
+int main()
+{
+	GliderCrossesChunks();
+	PentominoMatchesBoard();
+	EmptyChunksAreFreed();
+
+	std::printf("%s\n", failures == 0 ? "all sparse board checks passed" : "sparse board checks failed");
+	return failures == 0 ? 0 : 1;
+}
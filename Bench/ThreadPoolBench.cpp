@@ -0,0 +1,82 @@
+// Compares the per-generation cost of running row ranges on the persistent ThreadPool
+// with the spawn-and-join approach Board used to take (a std::jthread per range, every generation).
+//
+// usage: ThreadPoolBench [generations] [threads] [rows]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace
+{
+	using RowWork = ThreadPool::RowWork;
+
+	// the same split Board::FastDetermineNextState used before the pool
+	void SpawnAndJoin(int threadcount, uint16_t rows, const RowWork& work)
+	{
+		uint16_t rowStart = 0;
+		const auto rowsPerThread = static_cast<uint16_t>(rows / threadcount);
+		const auto remainingRows = static_cast<uint16_t>(rows % threadcount);
+
+		std::vector<std::jthread> threads;
+		for (int t = 0; t < threadcount - 1; t++)
+		{
+			threads.emplace_back(std::jthread{ work, t, rowStart, static_cast<uint16_t>(rowStart + rowsPerThread) });
+			rowStart += rowsPerThread;
+		}
+		threads.emplace_back(std::jthread{ work, threadcount - 1, rowStart, static_cast<uint16_t>(rowStart + rowsPerThread + remainingRows) });
+	}
+
+	template <typename F>
+	double MicrosecondsPerGeneration(int generations, F&& generation)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int g = 0; g < generations; g++)
+		{
+			generation();
+		}
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::micro>(end - start).count() / generations;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int generations = (argc > 1) ? std::atoi(argv[1]) : 5000;
+	int threadcount = (argc > 2) ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency() / 2);
+	threadcount = std::clamp(threadcount, 2, 8);
+	const auto rows = static_cast<uint16_t>((argc > 3) ? std::atoi(argv[3]) : 25);
+
+	// a tiny amount of work per row, like a small board, so the threading overhead dominates
+	std::vector<uint32_t> cells(static_cast<size_t>(rows) * 64);
+	const RowWork work = [&cells](int, uint16_t startRow, uint16_t endRow)
+		{
+			for (size_t i = startRow * size_t{ 64 }; i < endRow * size_t{ 64 }; i++)
+			{
+				cells[i] = cells[i] * 1664525u + 1013904223u;
+			}
+		};
+
+	ThreadPool pool;
+	pool.Start(threadcount);
+
+	// warm up both paths
+	MicrosecondsPerGeneration(100, [&] { SpawnAndJoin(threadcount, rows, work); });
+	MicrosecondsPerGeneration(100, [&] { pool.RunRowRanges(rows, work); });
+
+	const double spawn = MicrosecondsPerGeneration(generations, [&] { SpawnAndJoin(threadcount, rows, work); });
+	const double pooled = MicrosecondsPerGeneration(generations, [&] { pool.RunRowRanges(rows, work); });
+
+	std::printf("threads: %d rows: %u generations: %d\n", threadcount, rows, generations);
+	std::printf("spawn and join: %10.2f us/generation\n", spawn);
+	std::printf("thread pool:    %10.2f us/generation\n", pooled);
+	std::printf("speedup:        %10.2fx\n", spawn / pooled);
+
+	return 0;
+}
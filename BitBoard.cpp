@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include "BitBoard.h"
+
+#include <algorithm>
+
+#include <gsl/gsl>
+
+void BitBoard::Resize(uint16_t width, uint16_t height)
+{
+	_width = width;
+	_height = height;
+	_wordsPerRow = gsl::narrow_cast<uint16_t>((_width + 63) / 64);
+	_lastBit = gsl::narrow_cast<uint16_t>((_width - 1) & 63);
+	_lastMask = (_lastBit == 63) ? ~uint64_t{ 0 } : ((uint64_t{ 1 } << (_lastBit + 1)) - 1);
+
+	const size_t newsize = gsl::narrow_cast<size_t>(_wordsPerRow) * _height;
+	_words.assign(newsize, 0);
+	_next.assign(newsize, 0);
+}
+
+void BitBoard::Clear() noexcept
+{
+	std::fill(_words.begin(), _words.end(), 0);
+}
+
+uint64_t BitBoard::West(const uint64_t* row, uint16_t k) const noexcept
+{
+	// the cell left of x == 0 is the last cell in the row
+	const uint64_t carry = (k == 0) ? (row[_wordsPerRow - 1] >> _lastBit) & 1 : row[k - 1] >> 63;
+	return (row[k] << 1) | carry;
+}
+
+uint64_t BitBoard::East(const uint64_t* row, uint16_t k) const noexcept
+{
+	// the cell right of the last cell in the row is x == 0
+	const uint64_t carry = (k == _wordsPerRow - 1) ? (row[0] & 1) << _lastBit : row[k + 1] << 63;
+	return (row[k] >> 1) | carry;
+}
+
+BitBoard::NeighborCounts BitBoard::CountNeighbors(const uint64_t* above, const uint64_t* row, const uint64_t* below, uint16_t k) const noexcept
+{
+	return AddNeighbors(West(above, k), above[k], East(above, k), West(row, k), East(row, k), West(below, k), below[k], East(below, k));
+}
+
+void BitBoard::StepConwayRows(uint16_t startRow, uint16_t endRow) noexcept
+{
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const uint16_t yabove = (y == 0) ? _height - 1 : y - 1;
+		const uint16_t ybelow = (y == _height - 1) ? 0 : y + 1;
+
+		const uint64_t* above = Row(yabove);
+		const uint64_t* row = Row(y);
+		const uint64_t* below = Row(ybelow);
+		uint64_t* next = NextRow(y);
+
+		for (uint16_t k = 0; k < _wordsPerRow; k++)
+		{
+			const NeighborCounts count = CountNeighbors(above, row, below, k);
+
+			// count is 2 or 3 (eight neighbors has no twos, which is dead either way)
+			// alive with 2 or 3 survives, dead with exactly 3 is born
+			uint64_t result = count.twos & ~count.fours & (count.ones | row[k]);
+
+			if (k == _wordsPerRow - 1)
+			{
+				result &= _lastMask;
+			}
+			next[k] = result;
+		}
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// BitBoard packs 64 cells into each uint64_t, one bit per cell, row-major.
+// bit b of word k in row y is the cell at x = k * 64 + b
+// the board is a torus, like Board, so rows and columns wrap
+// bits beyond the board width in the last word of each row are always zero
+class BitBoard
+{
+public:
+    // live neighbor counts (0 to 8) of 64 cells as four bit planes, bit b of each plane belongs to cell b
+    struct NeighborCounts
+    {
+        uint64_t ones;
+        uint64_t twos;
+        uint64_t fours;
+        uint64_t eights;
+
+        // the cells whose count has its bit set in mask, e.g. 0b1100 for 2 or 3
+        [[nodiscard]] uint64_t Matching(uint16_t mask) const noexcept
+        {
+            uint64_t match = 0;
+            for (int n = 0; n <= 8; n++)
+            {
+                if ((mask >> n) & 1)
+                {
+                    match |= ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos) & ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+                }
+            }
+            return match;
+        }
+    };
+
+    BitBoard() = default;
+    ~BitBoard() = default;
+
+    // move/copy constuct
+    BitBoard(BitBoard&& b) = delete;
+    BitBoard(BitBoard& b) = delete;
+
+    // no need to assign one bitboard to another bitboard
+    BitBoard& operator=(BitBoard&& b) = delete;
+    BitBoard& operator=(BitBoard& b) = delete;
+
+    void Resize(uint16_t width, uint16_t height);
+    void Clear() noexcept;
+
+    [[nodiscard]] bool Get(uint16_t x, uint16_t y) const noexcept
+    {
+        return (_words[WordIndex(x, y)] >> (x & 63)) & 1;
+    }
+
+    void Set(uint16_t x, uint16_t y, bool alive) noexcept
+    {
+        const uint64_t bit = uint64_t{ 1 } << (x & 63);
+        uint64_t& word = _words[WordIndex(x, y)];
+        word = alive ? (word | bit) : (word & ~bit);
+    }
+
+    // computes the next Conway (B3/S23) generation for rows [startRow, endRow) into the back buffer
+    // only reads the current generation, so disjoint row ranges can run on different threads
+    void StepConwayRows(uint16_t startRow, uint16_t endRow) noexcept;
+
+    // counts the live neighbors of the 64 cells in word k of row, above and below are the rows around it
+    [[nodiscard]] NeighborCounts CountNeighbors(const uint64_t* above, const uint64_t* row, const uint64_t* below, uint16_t k) const noexcept;
+
+    // adds up eight neighbor words that are already lined up with the cells, e.g. nw has the cell up and to the left of each cell
+    // sums all 64 cells at once with a tree of full adders
+    [[nodiscard]] static NeighborCounts AddNeighbors(uint64_t nw, uint64_t n, uint64_t ne, uint64_t w, uint64_t e, uint64_t sw, uint64_t s, uint64_t se) noexcept
+    {
+        // weight 1 bits
+        uint64_t sa, ca, sb, cb;
+        FullAdd(nw, n, ne, sa, ca);
+        FullAdd(sw, s, se, sb, cb);
+        const uint64_t sc = w ^ e;
+        const uint64_t cc = w & e;
+
+        uint64_t ones, cd;
+        FullAdd(sa, sb, sc, ones, cd);
+
+        // weight 2 bits: ca, cb, cc, cd
+        uint64_t t2, t4;
+        FullAdd(ca, cb, cc, t2, t4);
+        const uint64_t c4 = t2 & cd;
+
+        return NeighborCounts{ ones, t2 ^ cd, t4 ^ c4, t4 & c4 };
+    }
+
+    // makes the back buffer the current generation
+    void Swap() noexcept
+    {
+        _words.swap(_next);
+    }
+
+    [[nodiscard]] const uint64_t* Row(uint16_t y) const noexcept
+    {
+        return _words.data() + (y * _wordsPerRow);
+    }
+
+    [[nodiscard]] const uint64_t* NextRow(uint16_t y) const noexcept
+    {
+        return _next.data() + (y * _wordsPerRow);
+    }
+
+    [[nodiscard]] uint64_t* NextRow(uint16_t y) noexcept
+    {
+        return _next.data() + (y * _wordsPerRow);
+    }
+
+    // the bits of the last word in a row that are on the board
+    [[nodiscard]] uint64_t LastMask() const noexcept
+    {
+        return _lastMask;
+    }
+
+    [[nodiscard]] uint16_t WordsPerRow() const noexcept
+    {
+        return _wordsPerRow;
+    }
+
+    [[nodiscard]] uint16_t Width() const noexcept
+    {
+        return _width;
+    }
+
+    [[nodiscard]] uint16_t Height() const noexcept
+    {
+        return _height;
+    }
+
+private:
+    // adds three 1-bit numbers in each of the 64 lanes
+    static void FullAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) noexcept
+    {
+        const uint64_t t = a ^ b;
+        sum = t ^ c;
+        carry = (a & b) | (t & c);
+    }
+
+    [[nodiscard]] size_t WordIndex(uint16_t x, uint16_t y) const noexcept
+    {
+        return (y * _wordsPerRow) + (x >> 6);
+    }
+
+    // each bit holds the cell to its left (West) or right (East), wrapping at the row edges
+    [[nodiscard]] uint64_t West(const uint64_t* row, uint16_t k) const noexcept;
+    [[nodiscard]] uint64_t East(const uint64_t* row, uint16_t k) const noexcept;
+
+private:
+    std::vector<uint64_t> _words;
+    std::vector<uint64_t> _next;
+
+    uint16_t _width{ 0 };
+    uint16_t _height{ 0 };
+    uint16_t _wordsPerRow{ 0 };
+    uint16_t _lastBit{ 0 };
+    uint64_t _lastMask{ 0 };
+};
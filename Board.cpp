@@ -8,6 +8,9 @@
 #include <iostream>
 #include <execution>
 #include <thread>
+#include <bit>
+#include <cmath>
+#include <cstring>
 
 #include <gsl/gsl>
 
@@ -24,7 +27,7 @@ std::wostream& operator<<(std::wostream& stream, Board& board)
 	{
 		for (uint16_t x = 0; x < board.Width(); x++)
 		{
-			const Cell& cell = board.GetCell(x, y);
+			const Cell cell = board.GetCell(x, y);
 			str += cell.GetEmojiStateString();
 		}
 		str += L"\r\n";
@@ -34,464 +37,1860 @@ std::wostream& operator<<(std::wostream& stream, Board& board)
 	return stream;
 }
 
+namespace
+{
+	// the Zobrist key of a cell in a state, from splitmix64 of the two rather than a table of random numbers,
+	// which would be bigger than the board; dead cells have no key, so an empty board hashes to 0
+	// masked instead of branching, births and deaths come in no predictable order
+	constexpr uint64_t ZobristKey(size_t index, Cell::State state) noexcept
+	{
+		uint64_t z = ((index * 8) + static_cast<uint64_t>(state) + 1) * 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return (z ^ (z >> 31)) & (uint64_t{ 0 } - uint64_t{ state != Cell::State::Dead });
+	}
+
+	// what the hash changes by when a cell goes from one state to another
+	constexpr uint64_t ZobristChange(size_t index, Cell::State from, Cell::State to) noexcept
+	{
+		return ZobristKey(index, from) ^ ZobristKey(index, to);
+	}
+}
 
-Board::Board() noexcept
+Board::Board()
 {
 	ML_METHOD;
 
 	_threadcount = gsl::narrow_cast<int>(std::thread::hardware_concurrency() / 2);
 	_threadcount = std::clamp(_threadcount, 2, 8);
+
+	// the workers live as long as the board, every generation reuses them
+	_pool.Start(_threadcount);
+	_partialCounts.resize(_threadcount);
+	_partialHashes.resize(_threadcount);
+	_partialChanges.resize(_threadcount);
+	_partialRewind.resize(_threadcount);
 }
 
-void Board::Update(BoardRules rules)
+void Board::ThreadCount(int threadcount)
 {
-	// TODO Alive Count is just not accurate
 	std::scoped_lock lock { _lockboard };
-	ResetCounts();
-	FastDetermineNextState(rules);
-	ApplyNextState();
+	_threadcount = std::max(threadcount, 1);
+	_pool.Start(_threadcount);
+	_partialCounts.assign(_threadcount, {});
+	_partialHashes.assign(_threadcount, 0);
+	_partialChanges.resize(_threadcount);
+	_partialRewind.resize(_threadcount);
 }
 
-void Board::Resize(uint16_t width, uint16_t height, uint16_t maxage)
+void Board::SetTopology(Topology topology)
 {
-	ML_METHOD;
+	std::scoped_lock lock { _lockboard };
+	_topology = topology;
+	BuildHalo();
+	InvalidateDerived();
+}
 
+void Board::Update(BoardRules rules)
+{
 	std::scoped_lock lock { _lockboard };
-	_height = height;
-	_width = width;
-	_maxage = maxage;
 
-	const size_t newsize = gsl::narrow_cast<size_t>(_width * _height);
-	if (newsize > _cells.capacity())
+	const Rule rule = Rule::Preset(rules);
+	if (ReplayCycle(rule))
 	{
-		// only reserve if we need more space
-		_cells.reserve(newsize);
+		return;
 	}
-	// always resize to the newsize even if it's smaller
-	_cells.resize(newsize);
 
-	//_cells.clear(); // this removes the items from the vector, but does not free the memory
+	const bool fastConway = rules == BoardRules::FastConway;
+	Step(rule, fastConway);
+	TrackCycle(rule);
+}
 
-	if (_cells.capacity() < newsize)
+void Board::Update(const Rule& rule)
+{
+	std::scoped_lock lock { _lockboard };
+	if (ReplayCycle(rule))
 	{
-		__debugbreak();
+		return;
 	}
 
-	ResetCounts();
-	_generation = 0;
-
-	//ML_TRACE("New board size: {}x{} cellcount: {} _cells.size:{}", _width, _height, newsize, _cells.size());
+	Step(rule, false);
+	TrackCycle(rule);
 }
 
-bool Board::CopyShape(Shape& shape, uint16_t startX, uint16_t startY)
+void Board::Update(const Rule& rule, uint32_t generations)
 {
-	ML_METHOD;
-	ResetCounts();
-	for (uint16_t y = 0; y < shape.Height(); y++)
-	{
-		for (uint16_t x = 0; x < shape.Width(); x++)
-		{
-			Cell& cell = GetCell(x + startX, y + startY);
-			if (shape.IsAlive(x, y))
-			{
-				
-				SetCell(cell, Cell::State::Live);
-			}
-			else
-			{
-				SetCell(cell, Cell::State::Dead);
-			}
-		}
-	}
-	return true;
+	std::scoped_lock lock { _lockboard };
+	StepGenerations(rule, generations, false);
 }
 
-void Board::PrintBoard()
+void Board::Update(BoardRules rules, uint32_t generations)
 {
-	std::wcout << (*this) << std::endl;
+	std::scoped_lock lock { _lockboard };
+	StepGenerations(Rule::Preset(rules), generations, rules == BoardRules::FastConway);
 }
 
-void Board::SetCell(Cell& cell, Cell::State state) noexcept
+void Board::StepGenerations(const Rule& rule, uint32_t generations, bool fastConway)
 {
-	// set the state to the new state
-	cell.SetState(state);
-
-	// update counts for the new states
-	switch (state)
+	// the blocks only know B/S rules, and a cross-surface's corners, where the diagonal neighbors go missing,
+	// can't be stepped ahead inside a block; incremental generations are already cheaper on the boards they're for,
+	// and so is the bit-packed board FastConway runs on
+	const bool bitwise = fastConway && _topology == Topology::Torus;
+	const bool blocked = !bitwise && !rule.IsGenerations() && _topology != Topology::CrossSurface && !_incremental;
+	while (generations > 0 && !IsPaused())
 	{
-		case Cell::State::Dead:
-		{
-			_numDead++;
-			break;
-		}
-		case Cell::State::Live:
-		{
-			_numLive++;
-			break;
-		}
-		case Cell::State::Born:
+		if (ReplayCycle(rule))
 		{
-			_numBorn++;
-			break;
+			generations--;
+			continue;
 		}
-		case Cell::State::Old:
+
+		// a cycle being recorded and a board that can be rewound need every generation
+		const auto block = gsl::narrow_cast<uint16_t>(std::min<uint32_t>(generations, _blockGenerations));
+		if (blocked && block > 1 && _cycleRecording == 0 && _rewindCap == 0)
 		{
-			_numOld++;
-			break;
+			ResetCounts();
+			BlockedNextState(rule, block);
+			generations -= block;
 		}
-		case Cell::State::Dying:
+		else
 		{
-			_numDying++;
-			break;
+			Step(rule, fastConway);
+			generations--;
 		}
-		default:
-			// do nothing
-			break;
+		TrackCycle(rule);
 	}
 }
 
-void Board::TurnCellOn(GridPoint g, bool on)
+void Board::Step(const Rule& rule, bool fastConway)
 {
-	if (g.x > Width() || g.y > Height())
+	Remember();
+	ResetCounts();
+
+	// the bit-packed board only wraps like a torus
+	if (fastConway && _topology == Topology::Torus)
 	{
+		BitwiseConwayNextState();
 		return;
 	}
 
-	Cell& cell = GetCell(g.x, g.y);
-	if (on)
+	NextState(rule);
+}
+
+uint64_t Board::Hash()
+{
+	if (_hashTracking && _hashInSync)
 	{
-		SetCell(cell, Cell::State::Live);
+		return _hash;
 	}
-	else
+
+	const uint64_t hash = ComputeHash();
+	if (_hashTracking)
 	{
-		SetCell(cell, Cell::State::Dead);
+		_hash = hash;
+		_hashInSync = true;
 	}
+	return hash;
 }
 
-void Board::CountLiveAndDyingNeighbors(uint16_t x, uint16_t y)
+uint64_t Board::ComputeHash()
 {
-	// don't do this it happens for every cell every frame and will spam the Log
-	ML_METHOD;
-
-	// calculate offsets that wrap
-	const uint16_t xoleft = (x == 0) ? _width - 1 : -1;
-	const uint16_t xoright = (x == (_width - 1)) ? -(_width - 1) : 1;
-	const uint16_t yoabove = (y == 0) ? _height - 1 : -1;
-	const uint16_t yobelow = (y == (_height - 1)) ? -(_height - 1) : 1;
-
-	uint8_t count{ 0 };
-
-	if (GetCell(x + xoleft, y + yobelow).IsAlive()) count++;
-	if (GetCell(x, y + yobelow).IsAlive()) count++;
-	if (GetCell(x + xoright, y + yobelow).IsAlive()) count++;
-
-	if (GetCell(x + xoleft, y + yoabove).IsAlive()) count++;
-	if (GetCell(x, y + yoabove).IsAlive()) count++;
-	if (GetCell(x + xoright, y + yoabove).IsAlive()) count++;
-
-	if (GetCell(x + xoleft, y).IsAlive()) count++;
-	if (GetCell(x + xoright, y).IsAlive()) count++;
+	_pool.RunRowRanges(Height(), [this](int range, uint16_t startRow, uint16_t endRow)
+		{
+			uint64_t hash = 0;
+			const size_t first = gsl::narrow_cast<size_t>(startRow) * _width;
+			const size_t last = gsl::narrow_cast<size_t>(endRow) * _width;
+			for (size_t i = first; i < last; i++)
+			{
+				if (_states[i] != Cell::State::Dead)
+				{
+					hash ^= ZobristKey(i, _states[i]);
+				}
+			}
+			_partialHashes[range] = hash;
+		});
 
-	GetCell(x,y).Neighbors(count);
+	uint64_t hash = 0;
+	for (auto& partial : _partialHashes)
+	{
+		hash ^= partial;
+		partial = 0;
+	}
+	return hash;
 }
 
-uint8_t Board::CountLiveNotDyingNeighbors(uint16_t x, uint16_t y)
+void Board::Snapshot(BoardSnapshot& snapshot)
 {
-	// calculate offsets that wrap
-	const uint16_t xoleft = (x == 0) ? _width - 1 : -1;
-	const uint16_t xoright = (x == (_width - 1)) ? -(_width - 1) : 1;
-	const uint16_t yoabove = (y == 0) ? _height - 1 : -1;
-	const uint16_t yobelow = (y == (_height - 1)) ? -(_height - 1) : 1;
-
-	uint8_t count{ 0 };
-
-	if (GetCell(x + xoleft, y + yobelow).IsAliveNotDying()) count++;
-	if (GetCell(x, y + yobelow).IsAliveNotDying()) count++;
-	if (GetCell(x + xoright, y + yobelow).IsAliveNotDying()) count++;
-
-	if (GetCell(x + xoleft, y + yoabove).IsAliveNotDying()) count++;
-	if (GetCell(x, y + yoabove).IsAliveNotDying()) count++;
-	if (GetCell(x + xoright, y + yoabove).IsAliveNotDying()) count++;
-
-	if (GetCell(x + xoleft, y).IsAliveNotDying()) count++;
-	if (GetCell(x + xoright, y).IsAliveNotDying()) count++;
-
-	GetCell(x,y).Neighbors(count);
-	return count;
+	std::scoped_lock lock { _lockboard };
+	snapshot.width = _width;
+	snapshot.height = _height;
+	snapshot.generation = _generation;
+	snapshot.liveCount = _counts.live;
+	snapshot.cycle = _cycle;
+	snapshot.sprites.resize(_states.size());
+
+	const uint16_t oldest = gsl::narrow_cast<uint16_t>(std::min(_maxage + 1, BoardSnapshot::NotDrawn - 1));
+	_pool.RunRowRanges(Height(), [this, &snapshot, oldest](int, uint16_t startRow, uint16_t endRow)
+		{
+			const size_t first = gsl::narrow_cast<size_t>(startRow) * _width;
+			const size_t last = gsl::narrow_cast<size_t>(endRow) * _width;
+			for (size_t i = first; i < last; i++)
+			{
+				const bool drawn = _states[i] == Cell::State::Live || _states[i] == Cell::State::Decaying;
+				snapshot.sprites[i] = drawn ? std::min(CellAge(i), oldest) : BoardSnapshot::NotDrawn;
+			}
+		});
 }
 
-void Board::ApplyNextState() noexcept
+void Board::RewindMemory(size_t bytes)
 {
-	_generation++;
-
-	std::for_each(std::execution::par, _cells.begin(), _cells.end(), [this](Cell& cell)
+	std::scoped_lock lock { _lockboard };
+	_rewindCap = bytes;
+	if (bytes == 0)
 	{
-			const auto state = cell.GetState();
-			if (state == Cell::State::Live)
-			{
-				SetCell(cell, Cell::State::Live);
-			}
-			else if (state == Cell::State::Dying || state == Cell::State::Dead)
-			{
-				SetCell(cell, Cell::State::Dead);
-			}
-			else if (state == Cell::State::Born)
-			{
-				SetCell(cell, Cell::State::Live);
-				cell.Age(0);
-			}
+		ForgetRewind();
+		return;
+	}
+	TrimRewind();
+}
 
-			cell.GetOlder();
-		});
+bool Board::Rewind(uint32_t generations)
+{
+	// the target comes from the generation under the same lock as the seek, the simulation thread may be stepping
+	std::scoped_lock lock { _lockboard };
+	return generations <= _generation && Seek(_generation - generations);
+}
 
-	// does not use std::execution::par
-	//for (auto& cell : _cells)
-	//{
-	//	const auto state = cell.GetState();
-	//	if (state == Cell::State::Live)
-	//	{
-	//		SetCell(cell, Cell::State::Live);
-	//	}
-	//	else if (state == Cell::State::Dying || state == Cell::State::Dead)
-	//	{
-	//		SetCell(cell, Cell::State::Dead);
-	//	}
-	//	else if (state == Cell::State::Born)
-	//	{
-	//		SetCell(cell, Cell::State::Live);
-	//		cell.Age(0);
-	//	}
-
-	//	cell.GetOlder();
-	//}
+bool Board::SeekGeneration(uint32_t generation)
+{
+	std::scoped_lock lock { _lockboard };
+	return Seek(generation);
 }
 
-void Board::RandomizeBoard(float alivepct, uint16_t maxage)
+// SeekGeneration with _lockboard held
+bool Board::Seek(uint32_t generation)
 {
-	ResetCounts();
-	_generation = 0;
-	_maxage = maxage;
+	if (generation == _generation)
+	{
+		return true;
+	}
 
-	// TODO use XOSHIRO instead
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<> pdis(0.0, 1.0);
-	std::uniform_int_distribution<int> adis(0, maxage);
+	// a generation that was just computed isn't remembered until the next one starts
+	if (_rewindCap > 0 && (_rewindFrames.empty() || _rewindFrames.back().generation < _generation))
+	{
+		Remember();
+	}
+	if (_rewindFrames.empty() || generation < _rewindFrames.front().generation || generation > _rewindFrames.back().generation)
+	{
+		return false;
+	}
 
-	double rp = 0.0f;
-	int ra = 0;
+	// from the keyframe at or before the generation, through the changes of every frame up to it
+	const size_t target = generation - _rewindFrames.front().generation;
+	size_t frame = target;
+	while (!_rewindFrames[frame].keyframe)
+	{
+		frame--;
+	}
+	std::copy(_rewindFrames[frame].states.begin(), _rewindFrames[frame].states.end(), _states.begin());
+	std::copy(_rewindFrames[frame].births.begin(), _rewindFrames[frame].births.end(), _births.begin());
+	for (frame++; frame <= target; frame++)
 	{
-		std::scoped_lock lock { _lockboard };
-		for (auto& cell : _cells)
+		for (const RewindChange& change : _rewindFrames[frame].changes)
 		{
-			rp = pdis(gen);
-			if (rp <= alivepct)
-			{
-				SetCell(cell, Cell::State::Live);
-				ra = adis(gen);
-				cell.Age(gsl::narrow_cast<uint16_t>(ra));
-			}
-			else
-			{
-				SetCell(cell, Cell::State::Dead);
-			}
+			_states[change.index] = change.state;
+			_births[change.index] = change.birth;
 		}
 	}
+
+	_counts = _rewindFrames[target].counts;
+	_generation = generation;
+	InvalidateDerived();
+	_hashInSync = false;
+	return true;
 }
 
-void Board::UpdateRowsWithNextState(uint16_t startRow, uint16_t endRow, BoardRules rules)
+void Board::Remember()
 {
-	using RuleMethod = void (Board::*)(Cell&) const noexcept;
-	RuleMethod f_rules = &Board::FastConwayRules;
+	if (_rewindCap == 0)
+	{
+		return;
+	}
 
-	switch (rules)
+	// a board that was moved back carries on from here, and the generations it had after this one go
+	bool follows = !_rewindFrames.empty() && _rewindFrames.back().generation + 1 == _generation && _rewindStates.size() == _states.size();
+	while (!_rewindFrames.empty() && _rewindFrames.back().generation >= _generation)
 	{
-		case BoardRules::FastConway:	f_rules = &Board::FastConwayRules; break;
-		case BoardRules::DayAndNight:	f_rules = &Board::DayAndNightRules; break;
-		case BoardRules::LifeWithoutDeath:	f_rules = &Board::LifeWithoutDeathRules; break;
-		case BoardRules::BriansBrain:	f_rules = &Board::BriansBrainRules; break;
-		case BoardRules::Seeds:	f_rules = &Board::SeedsRules; break;
-		case BoardRules::Highlife:	f_rules = &Board::HighlifeRules; break;
-		case BoardRules::Conway: f_rules = &Board::ConwayRules; break;
-		default: f_rules = &Board::ConwayRules; break;
+		_rewindBytes -= _rewindFrames.back().Bytes();
+		_rewindFrames.pop_back();
+		follows = false;
 	}
 
-	for (uint16_t y = startRow; y < endRow; y++)
+	// the generations have to follow each other, anything else starts over
+	if (!_rewindFrames.empty() && _rewindFrames.back().generation + 1 != _generation)
 	{
-		for (uint16_t x = 0; x < Width(); x++)
-		{
-			Cell& cell = GetCell(x, y);
-			CountLiveAndDyingNeighbors(x, y);
-			std::invoke(f_rules, this, cell);
-		}
+		ForgetRewind();
 	}
-}
 
-void Board::FastDetermineNextState(BoardRules rules)
-{
-	ML_METHOD;
+	const auto keyframe = std::find_if(_rewindFrames.rbegin(), _rewindFrames.rend(), [](const RewindFrame& frame) noexcept { return frame.keyframe; });
+	if (!follows || keyframe == _rewindFrames.rend() || _generation - keyframe->generation >= _rewindKeyframes)
+	{
+		RememberKeyframe();
+		return;
+	}
 
-	uint16_t rowStart = 0;
-	const auto rowsPerThread = gsl::narrow_cast<uint16_t>(Height() / _threadcount);
-	const auto remainingRows = gsl::narrow_cast<uint16_t>(Height() % _threadcount);
+	// each thread lists the cells in its rows that changed since the last frame
+	_partialRewind.resize(_threadcount);
+	_pool.RunRowRanges(Height(), [this](int range, uint16_t startRow, uint16_t endRow)
+		{
+			_partialRewind[range].clear();
+			FindRewindChanges(startRow, endRow, _partialRewind[range]);
+		});
 
-	std::vector<std::jthread> threads;
-	for (int t = 0; t < _threadcount - 1; t++)
+	// once the changes since the keyframe add up to more than a keyframe, a new keyframe is smaller
+	// and keeps a seek from going through more than about two keyframes' worth of memory
+	size_t changed = 0;
+	for (const auto& changes : _partialRewind)
 	{
-		ML_TRACE("FastDetermineNextState Start Row: {} EndRow: {}", rowStart, rowStart + rowsPerThread);
-
-		threads.emplace_back(std::jthread{ &Board::UpdateRowsWithNextState, this, rowStart, gsl::narrow_cast<uint16_t>(rowStart + rowsPerThread), rules });
-		rowStart += rowsPerThread;
+		changed += changes.size();
+	}
+	size_t sinceKeyframe = changed;
+	for (auto frame = keyframe.base(); frame != _rewindFrames.end(); ++frame)
+	{
+		sinceKeyframe += frame->changes.size();
+	}
+	if (sinceKeyframe * sizeof(RewindChange) >= Size() * (sizeof(Cell::State) + sizeof(uint16_t)))
+	{
+		RememberKeyframe();
+		return;
+	}
 
+	RewindFrame& frame = _rewindFrames.emplace_back();
+	frame.generation = _generation;
+	frame.counts = _counts;
+	frame.changes.reserve(changed);
+	for (const auto& changes : _partialRewind)
+	{
+		frame.changes.insert(frame.changes.end(), changes.begin(), changes.end());
 	}
-	ML_TRACE("FastDetermineNextState Start Row: {} EndRow: {}", rowStart, rowStart + rowsPerThread + remainingRows);
-	threads.emplace_back(std::jthread{ &Board::UpdateRowsWithNextState, this, rowStart, gsl::narrow_cast<uint16_t>(rowStart + rowsPerThread + remainingRows), rules });
+	_rewindBytes += frame.Bytes();
+	TrimRewind();
 }
 
-void Board::ConwayRules(Cell& cell) const noexcept
+void Board::RememberKeyframe()
 {
-	// Any live cell with two or three live neighbours survives.
-	// Any dead cell with three live neighbours becomes a live cell.
-	// All other live cells die in the next generation. Similarly, all other dead cells stay dead.
+	RewindFrame& frame = _rewindFrames.emplace_back();
+	frame.generation = _generation;
+	frame.counts = _counts;
+	frame.keyframe = true;
+	frame.states = _states;
+	frame.births = _births;
+	_rewindStates = _states;
+	_rewindBirths = _births;
+	_rewindBytes += frame.Bytes();
+	TrimRewind();
+}
 
-	const uint16_t count = cell.Neighbors();
+void Board::FindRewindChanges(uint16_t startRow, uint16_t endRow, std::vector<RewindChange>& changes)
+{
+	// 8 cells at a time are skipped when none of them changed, which is most of them on a settled board
+	// the copy of the board is brought up to date as the changes are found
+	const auto check = [&](size_t i)
+		{
+			if (_states[i] != _rewindStates[i] || _births[i] != _rewindBirths[i])
+			{
+				changes.push_back({ gsl::narrow_cast<uint32_t>(i), _births[i], _states[i] });
+				_rewindStates[i] = _states[i];
+				_rewindBirths[i] = _births[i];
+			}
+		};
 
-	if (cell.IsAlive() && count >= 2 && count <= 3)
+	const size_t first = gsl::narrow_cast<size_t>(startRow) * _width;
+	const size_t last = gsl::narrow_cast<size_t>(endRow) * _width;
+	size_t i = first;
+	for (; i + 8 <= last; i += 8)
 	{
-		cell.SetState(Cell::State::Live);
+		if (std::memcmp(&_states[i], &_rewindStates[i], 8 * sizeof(Cell::State)) != 0 || std::memcmp(&_births[i], &_rewindBirths[i], 8 * sizeof(uint16_t)) != 0)
+		{
+			for (size_t j = i; j < i + 8; j++)
+			{
+				check(j);
+			}
+		}
 	}
-	else if (cell.IsDead() && count == 3)
+	for (; i < last; i++)
 	{
-		cell.SetState(Cell::State::Born);
+		check(i);
 	}
-	else if (cell.IsAlive())
+}
+
+void Board::TrimRewind() noexcept
+{
+	// the oldest keyframe goes with the frames that need it, the newest keyframe always stays
+	while (RewindMemoryUsed() > _rewindCap)
 	{
-		cell.SetState(Cell::State::Dying);
+		const auto next = std::find_if(std::next(_rewindFrames.begin()), _rewindFrames.end(), [](const RewindFrame& frame) noexcept { return frame.keyframe; });
+		if (_rewindFrames.empty() || next == _rewindFrames.end())
+		{
+			break;
+		}
+		for (auto frame = _rewindFrames.begin(); frame != next; ++frame)
+		{
+			_rewindBytes -= frame->Bytes();
+		}
+		_rewindFrames.erase(_rewindFrames.begin(), next);
 	}
 }
 
-void Board::FastConwayRules(Cell& cell) const noexcept
+void Board::ForgetRewind() noexcept
 {
-	const uint16_t count = cell.Neighbors();
-
-	cell.SetState(
-		cell.IsAlive() && count >= 2 && count <= 3 ? Cell::State::Live
-		: cell.IsDead() && count == 3 ? Cell::State::Born
-		: cell.IsAlive() ? Cell::State::Dying : Cell::State::Dead
-	);
+	_rewindFrames.clear();
+	_rewindStates.clear();
+	_rewindBirths.clear();
+	_rewindBytes = 0;
 }
 
-void Board::DayAndNightRules(Cell& cell) const noexcept
+void Board::TrackCycle(const Rule& rule)
 {
-	// https://en.wikipedia.org/wiki/Day_and_Night_(cellular_automaton)
-	// rule notation B3678/S34678, meaning that
-	// a dead cell becomes live (is born) if it has 3, 6, 7, or 8 live neighbors
-	// live cell remains alive (survives) if it has 3, 4, 6, 7, or 8 live neighbors,
-
-	const uint16_t count = cell.Neighbors();
-
-	if (cell.IsAlive() && ((count >= 3) && (count != 5)))
+	if (_cycleAction == CycleAction::Off || _cycle.period != 0)
 	{
-		cell.SetState(Cell::State::Live);
+		return;
 	}
-	else if (cell.IsDead() && (count == 3 || count >= 6))
+
+	if (!(rule == _cycleRule))
 	{
-		cell.SetState(Cell::State::Born);
+		ForgetCycle();
+		_cycleRule = rule;
 	}
-	else if (cell.IsAlive())
+
+	// past C3 every decay stage is Decaying in _states, so boards that hash and compare the same can still differ
+	if (rule.States() > 3)
 	{
-		cell.SetState(Cell::State::Dying);
+		return;
 	}
-}
-
-void Board::LifeWithoutDeathRules(Cell& cell) const noexcept
-{
-	// https://en.wikipedia.org/wiki/Life_without_Death
-	// every cell that was alive in the previous pattern remains alive,
-	// every dead cell that has exactly 3 live neighbors becomes alive itself
-	// and every other dead cell remains dead. B3/S012345678
 
-	const uint16_t count = cell.Neighbors();
+	const uint64_t hash = Hash();
+	if (_cycleRecording > 0)
+	{
+		RecordCycle(hash);
+		return;
+	}
 
-	if (cell.IsDead() && count == 3)
+	// a repeated hash starts a recording of the generations up to the next repeat, the board is compared at the end of it
+	_cycleHistory.push_back({ _generation, hash });
+	for (auto entry = std::next(_cycleHistory.rbegin()); entry != _cycleHistory.rend(); ++entry)
 	{
-		cell.SetState(Cell::State::Born);
+		if (entry->hash == hash)
+		{
+			const uint32_t generations = _generation - entry->generation;
+			if (generations <= MaxCyclePeriod)
+			{
+				_cycleRecording = generations;
+				_cycleHashes.assign(1, hash);
+				_cycleStart = _states;
+				if (_cycleAction == CycleAction::Replay)
+				{
+					_cycleBirths = _births;
+				}
+			}
+			break;
+		}
 	}
-	if (cell.IsDying())
+
+	if (_cycleHistory.size() > CycleHistory)
 	{
-		// should never happen
-		cell.SetState(Cell::State::Live);
+		_cycleHistory.erase(_cycleHistory.begin());
 	}
 }
 
-void Board::HighlifeRules(Cell& cell) const noexcept
+void Board::RecordCycle(uint64_t hash)
 {
-	// https://en.wikipedia.org/wiki/Highlife_(cellular_automaton)
-	// the rule B36 / S23; that is,
-	// a cell is born if it has 3 or 6 neighbors
-	// and survives if it has 2 or 3 neighbors.
+	if (_cycleAction == CycleAction::Replay)
+	{
+		const std::vector<Cell::State>& before = _cyclePhases.empty() ? _cycleStart : _cycleBefore;
+		CyclePhase& phase = _cyclePhases.emplace_back();
+		for (uint32_t i = 0; i < Size(); i++)
+		{
+			const bool born = _births[i] != _cycleBirths[i];
+			if (born || _states[i] != before[i])
+			{
+				phase.changes.push_back({ i, _states[i], born });
+			}
+		}
+		phase.counts = _counts;
+		_cycleBefore = _states;
+		_cycleBirths = _births;
+	}
+	_cycleHashes.push_back(hash);
 
-	const uint16_t count = cell.Neighbors();
+	if (--_cycleRecording > 0)
+	{
+		return;
+	}
 
-	if (cell.IsAlive() && ((count == 2) || (count == 3)))
+	// the hashes matched but the boards don't
+	if (_states != _cycleStart)
 	{
-		cell.SetState(Cell::State::Live);
+		ForgetCycle();
+		return;
 	}
-	else
-	if (cell.IsDead() && ((count == 3) || (count == 6)))
+
+	// the shortest period that divides the recorded one
+	const auto generations = gsl::narrow_cast<uint32_t>(_cycleHashes.size() - 1);
+	uint32_t period = generations;
+	for (uint32_t p = 1; p < generations; p++)
 	{
-		cell.SetState(Cell::State::Born);
+		if (generations % p == 0 && _cycleHashes[p] == _cycleHashes[0])
+		{
+			period = p;
+			break;
+		}
 	}
-	else
+
+	// go back through the history as long as it matches the cycle
+	const uint32_t recorded = _generation - generations;
+	uint32_t first = recorded;
+	for (auto entry = _cycleHistory.rbegin(); entry != _cycleHistory.rend(); ++entry)
 	{
-		cell.SetState(Cell::State::Dying);
+		const uint32_t phase = (period - ((recorded - entry->generation) % period)) % period;
+		if (_cycleHashes[phase] != entry->hash)
+		{
+			break;
+		}
+		first = entry->generation;
 	}
+
+	std::vector<CyclePhase> phases = std::move(_cyclePhases);
+	phases.resize(std::min<size_t>(phases.size(), period));
+	ForgetCycle();
+	_cycle = { period, first };
+	_cyclePhases = std::move(phases);
 }
 
-void Board::SeedsRules(Cell& cell) const noexcept
+bool Board::ReplayCycle(const Rule& rule)
 {
-	// https://en.wikipedia.org/wiki/Seeds_(cellular_automaton)
-	// In each time step, a cell turns on or is "born" if it was off or "dead"
-	// but had exactly two neighbors that were on
-	// all other cells turn off. It is described by the rule B2 / S
-
-	const uint16_t count = cell.Neighbors();
+	if (_cycle.period == 0)
+	{
+		return false;
+	}
 
-	if (cell.IsDead() && count == 2)
+	if (!(rule == _cycleRule))
 	{
-		cell.SetState(Cell::State::Born);
+		ForgetCycle();
+		return false;
 	}
-	else
+
+	if (_cycleAction != CycleAction::Replay)
 	{
-		cell.SetState(Cell::State::Dying);
+		// a paused board stays where it is, a detected one keeps running
+		return _cycleAction == CycleAction::Pause;
 	}
-}
 
-void Board::BriansBrainRules(Cell& cell) const noexcept
-{
-	// https://en.wikipedia.org/wiki/Brian%27s_Brain
-	// In each time step, a cell turns on if it was off but had exactly two neighbors that were on,
-	// just like the birth rule for Seeds. All cells that were "on" go into the "dying" state,
-	// which is not counted as an "on" cell in the neighbor count, and prevents any cell from
-	// being born there. Cells that were in the dying state go into the off state.
+	Remember();
+	const auto start = std::chrono::steady_clock::now();
+	const CyclePhase& phase = _cyclePhases[_cyclePhase];
+	for (const CycleChange& change : phase.changes)
+	{
+		_hash ^= ZobristChange(change.index, _states[change.index], change.state);
+		_states[change.index] = change.state;
+		if (change.born)
+		{
+			_births[change.index] = gsl::narrow_cast<uint16_t>(_generation);
+		}
+	}
+	_counts = phase.counts;
+	_generation++;
+	_cyclePhase = (_cyclePhase + 1) % _cycle.period;
 
-	const uint16_t count = cell.Neighbors();
-	
-	// Cell::State::BrianDying is a special case for this ruleset
-	// so that Dying cells draw as well as Live cells
-	if (cell.GetState() == Cell::State::BrianDying)
+	// a still life changes nothing, anything else has to be rebuilt if the board goes back to computing
+	if (!phase.changes.empty())
 	{
-		cell.SetState(Cell::State::Dying);
+		_bitsInSync = false;
+		_planesInSync = false;
+		_aliveInSync = false;
+		_tilesInSync = false;
+		_neighborsInSync = false;
 	}
-	else
-	if (cell.GetState() == Cell::State::Live)
+
+	const auto now = std::chrono::steady_clock::now();
+	RecordPhaseTimes(start, now, now);
+	return true;
+}
+
+void Board::NextState(const Rule& rule)
+{
+	if (rule.IsGenerations())
 	{
-		cell.Age(_maxage +1);
-		cell.SetState(Cell::State::BrianDying);
+		GenerationsNextState(rule);
+		return;
 	}
-	else
-	if (cell.IsDead() && count == 2)
+
+	// B/S rules change the Cells directly, so the bits and planes will need to be reloaded
+	_bitsInSync = false;
+	_planesInSync = false;
+	if (_incremental)
 	{
-		cell.SetState(Cell::State::Born);
+		IncrementalNextState(rule);
+		return;
 	}
+	FastDetermineNextState(rule);
+}
+
+void Board::Resize(uint16_t width, uint16_t height, uint16_t maxage)
+{
+	ML_METHOD;
+
+	std::scoped_lock lock { _lockboard };
+	_height = height;
+	_width = width;
+	_maxage = maxage;
+
+	const size_t newsize = gsl::narrow_cast<size_t>(_width * _height);
+	if (newsize > _states.capacity())
+	{
+		// only reserve if we need more space
+		_states.reserve(newsize);
+	}
+	// always resize to the newsize even if it's smaller
+	_states.resize(newsize);
+	_nextstates.resize(newsize);
+	_births.resize(newsize);
+	_stride = _width + 2u;
+	const size_t paddedsize = gsl::narrow_cast<size_t>(_stride) * (_height + 2u);
+	_neighbors.assign(paddedsize, 0);
+	_alive.assign(paddedsize, 0);
+	_nextalive.assign(paddedsize, 0);
+	_candidate.assign(paddedsize, 0);
+	_candidates.clear();
+	BuildHalo();
+	_bits.Resize(_width, _height);
+	_tilesAcross = gsl::narrow_cast<uint16_t>((_width + TileSize - 1) / TileSize);
+	_tilesDown = gsl::narrow_cast<uint16_t>((_height + TileSize - 1) / TileSize);
+	_tileChanged.assign(GetTileCount(), 0);
+	_tileActive.assign(GetTileCount(), 0);
+	InvalidateDerived();
+	// the keys go by index, which moved
+	_hashInSync = false;
+	ForgetRewind();
+
+	//_states.clear(); // this removes the items from the vector, but does not free the memory
+
+	if (_states.capacity() < newsize)
+	{
+		__debugbreak();
+	}
+
+	// ages count from the generation, which starts over
+	for (auto& birth : _births)
+	{
+		birth -= gsl::narrow_cast<uint16_t>(_generation);
+	}
+
+	ResetCounts();
+	_generation = 0;
+
+	//ML_TRACE("New board size: {}x{} cellcount: {} _states.size:{}", _width, _height, newsize, _states.size());
+}
+
+bool Board::CopyShape(Shape& shape, uint16_t startX, uint16_t startY)
+{
+	ML_METHOD;
+	if (startX >= _width || startY >= _height)
+	{
+		return false;
+	}
+
+	// SetCell doesn't check the index, so the part of the shape past the edges is left out
+	const uint16_t width = std::min<uint16_t>(shape.Width(), _width - startX);
+	const uint16_t height = std::min<uint16_t>(shape.Height(), _height - startY);
+
+	ResetCounts();
+	InvalidateDerived();
+	for (uint16_t y = 0; y < height; y++)
+	{
+		for (uint16_t x = 0; x < width; x++)
+		{
+			const size_t index = (x + startX) + ((y + startY) * _width);
+			if (shape.IsAlive(x, y))
+			{
+				
+				SetCell(index, Cell::State::Live);
+			}
+			else
+			{
+				SetCell(index, Cell::State::Dead);
+			}
+		}
+	}
+	return width == shape.Width() && height == shape.Height();
+}
+
+void Board::PrintBoard()
+{
+	std::wcout << (*this) << std::endl;
+}
+
+void Board::SetCell(size_t index, Cell::State state) noexcept
+{
+	// set the state to the new state, a cell that's born starts at age 0 like Cell::SetState
+	if (state == Cell::State::Born && _states[index] != Cell::State::Born)
+	{
+		CellAge(index, 0);
+	}
+	_hash ^= ZobristChange(index, _states[index], state);
+	_states[index] = state;
+
+	// update counts for the new states
+	switch (state)
+	{
+		case Cell::State::Dead:
+		{
+			_counts.dead++;
+			break;
+		}
+		case Cell::State::Live:
+		{
+			_counts.live++;
+			break;
+		}
+		case Cell::State::Born:
+		{
+			_counts.born++;
+			break;
+		}
+		case Cell::State::Old:
+		{
+			_counts.old++;
+			break;
+		}
+		case Cell::State::Dying:
+		{
+			_counts.dying++;
+			break;
+		}
+		default:
+			// do nothing
+			break;
+	}
+}
+
+void Board::TurnCellOn(GridPoint g, bool on)
+{
+	if (g.x >= Width() || g.y >= Height())
+	{
+		return;
+	}
+
+	InvalidateDerived();
+	const size_t index = g.x + (g.y * _width);
+	if (on)
+	{
+		SetCell(index, Cell::State::Live);
+	}
+	else
+	{
+		SetCell(index, Cell::State::Dead);
+	}
+}
+
+void Board::CountLiveAndDyingNeighbors(uint16_t x, uint16_t y)
+{
+	// don't do this it happens for every cell every frame and will spam the Log
+	ML_METHOD;
+
+	// the alive bytes and their halo must be in sync, then no neighbor needs a wrap
+	const size_t index = PaddedIndex(x, y);
+	const uint8_t* above = &_alive[index - _stride];
+	const uint8_t* row = &_alive[index];
+	const uint8_t* below = &_alive[index + _stride];
+
+	_neighbors[index] = above[-1] + above[0] + above[1]
+		+ row[-1] + row[1]
+		+ below[-1] + below[0] + below[1];
+}
+
+uint8_t Board::CountLiveNotDyingNeighbors(uint16_t x, uint16_t y)
+{
+	// the states have no halo, so this one still wraps like the torus
+	const uint16_t xoleft = (x == 0) ? _width - 1 : -1;
+	const uint16_t xoright = (x == (_width - 1)) ? -(_width - 1) : 1;
+	const uint16_t yoabove = (y == 0) ? _height - 1 : -1;
+	const uint16_t yobelow = (y == (_height - 1)) ? -(_height - 1) : 1;
+
+	uint8_t count{ 0 };
+
+	if (Cell::IsAliveNotDying(StateAt(x + xoleft, y + yobelow))) count++;
+	if (Cell::IsAliveNotDying(StateAt(x, y + yobelow))) count++;
+	if (Cell::IsAliveNotDying(StateAt(x + xoright, y + yobelow))) count++;
+
+	if (Cell::IsAliveNotDying(StateAt(x + xoleft, y + yoabove))) count++;
+	if (Cell::IsAliveNotDying(StateAt(x, y + yoabove))) count++;
+	if (Cell::IsAliveNotDying(StateAt(x + xoright, y + yoabove))) count++;
+
+	if (Cell::IsAliveNotDying(StateAt(x + xoleft, y))) count++;
+	if (Cell::IsAliveNotDying(StateAt(x + xoright, y))) count++;
+
+	_neighbors[PaddedIndex(x, y)] = count;
+	return count;
+}
+
+void Board::ReducePartialCounts() noexcept
+{
+	_counts = {};
+	for (auto& partial : _partialCounts)
+	{
+		_counts += partial;
+		partial = {};
+	}
+	for (auto& partial : _partialHashes)
+	{
+		_hash ^= partial;
+		partial = 0;
+	}
+}
+
+void Board::RandomizeBoard(float alivepct, uint16_t maxage)
+{
+	std::random_device rd;
+	const uint64_t seed = (uint64_t{ rd() } << 32) | rd();
+	RandomizeBoard(alivepct, maxage, seed);
+}
+
+void Board::RandomizeBoard(float alivepct, uint16_t maxage, uint64_t seed)
+{
+	ResetCounts();
+	_generation = 0;
+	_maxage = maxage;
+	InvalidateDerived();
+	ForgetRewind();
+	_hash = 0;
+	_hashInSync = true;
+
+	const uint32_t probability = gsl::narrow_cast<uint32_t>(std::clamp(std::lround(alivepct * Xoshiro256::ProbabilityOne), 0L, static_cast<long>(Xoshiro256::ProbabilityOne)));
+	const uint16_t bands = gsl::narrow_cast<uint16_t>((_height + RandomBandRows - 1) / RandomBandRows);
+
+	std::scoped_lock lock { _lockboard };
+
+	// band b always uses the stream the seed jumped b times, so how the bands are split between threads doesn't matter
+	_pool.RunRowRanges(bands, [this, seed, probability](int range, uint16_t startBand, uint16_t endBand)
+		{
+			Xoshiro256 stream(seed);
+			for (uint16_t band = 0; band < startBand; band++)
+			{
+				stream.Jump();
+			}
+
+			for (uint16_t band = startBand; band < endBand; band++)
+			{
+				Xoshiro256 random = stream;
+				const uint16_t startRow = band * RandomBandRows;
+				const uint16_t endRow = std::min(gsl::narrow_cast<uint16_t>(startRow + RandomBandRows), _height);
+				RandomizeRows(startRow, endRow, probability, random, _partialCounts[range], _partialHashes[range]);
+				stream.Jump();
+			}
+		});
+
+	ReducePartialCounts();
+}
+
+// 64 cells at a time from one Bernoulli word, and a random age for each live cell
+void Board::RandomizeRows(uint16_t startRow, uint16_t endRow, uint32_t probability, Xoshiro256& random, GenerationCounts& counts, uint64_t& hash) noexcept
+{
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const size_t row = gsl::narrow_cast<size_t>(y) * _width;
+		for (uint32_t x = 0; x < _width; x += 64)
+		{
+			const uint64_t alive = random.Bernoulli(probability);
+			const uint32_t end = std::min(x + 64, uint32_t{ _width });
+			for (uint32_t i = x; i < end; i++)
+			{
+				if ((alive >> (i - x)) & 1)
+				{
+					_states[row + i] = Cell::State::Live;
+					CellAge(row + i, gsl::narrow_cast<uint16_t>(random.Below(_maxage + 1u)));
+					counts.live++;
+					hash ^= _hashTracking ? ZobristKey(row + i, Cell::State::Live) : 0;
+				}
+				else
+				{
+					_states[row + i] = Cell::State::Dead;
+					counts.dead++;
+				}
+			}
+		}
+	}
+}
+
+void Board::Clear()
+{
+	ResetCounts();
+	_generation = 0;
+	InvalidateDerived();
+	ForgetRewind();
+
+	std::scoped_lock lock { _lockboard };
+	std::fill(_states.begin(), _states.end(), Cell::State::Dead);
+	std::fill(_births.begin(), _births.end(), uint16_t{ 0 });
+	_counts.dead = Size();
+	_hash = 0;
+	_hashInSync = true;
+}
+
+void Board::UpdateRowsWithNextState(uint16_t startRow, uint16_t endRow, const Rule& rule, GenerationCounts& counts, uint64_t& hash)
+{
+	// the kernel counts a tile's span of the row at a time from the alive bytes of the current generation
+	// into the neighbor plane, then the rule table (indexed by the alive byte and the count)
+	// gives the next state, all in one pass
+	// only the alive bytes, the states and the neighbor counts are touched, ages only on a birth
+	// startRow is always the first row of a tile, so each tile belongs to a single thread
+	GenerationCounts local;
+	uint64_t hashChanges = 0;
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		// the rows above and below are always there, the halo takes care of the edges
+		const size_t rowStart = gsl::narrow_cast<size_t>(y) * _width;
+		const size_t paddedStart = PaddedIndex(0, y);
+		const uint8_t* alive = &_alive[paddedStart];
+		const uint8_t* above = alive - _stride;
+		const uint8_t* below = alive + _stride;
+		const Cell::State* row = &_states[rowStart];
+		Cell::State* nextrow = &_nextstates[rowStart];
+		uint8_t* neighbors = &_neighbors[paddedStart];
+		uint8_t* nextalive = &_nextalive[paddedStart];
+
+		const uint8_t* tileActive = &_tileActive[(y / TileSize) * _tilesAcross];
+		uint8_t* tileChanged = &_tileChanged[(y / TileSize) * _tilesAcross];
+
+		for (uint16_t tx = 0; tx < _tilesAcross; tx++)
+		{
+			const uint16_t start = tx * TileSize;
+			const uint16_t end = std::min(gsl::narrow_cast<uint16_t>(start + TileSize), Width());
+
+			if (!tileActive[tx])
+			{
+				// nothing in or around this tile changed, so neither will the tile, which is only Live and Dead cells
+				std::copy(row + start, row + end, nextrow + start);
+				std::copy(alive + start, alive + end, nextalive + start);
+				const auto live = gsl::narrow_cast<uint32_t>(std::count(alive + start, alive + end, uint8_t{ 1 }));
+				local.live += live;
+				local.dead += (end - start) - live;
+				continue;
+			}
+
+			_kernel.CountPaddedSpan(above, alive, below, neighbors, start, end);
+
+			// the rule table only gives Born, Live, Dying and Dead, which end up as Live and Dead,
+			// so the next state comes from the alive table and the alive bytes, without branches
+			// births are only collected as bits and written after the loop, a store in the loop would be turned
+			// into a read and write of every cell's birth generation
+			// the states that changed are collected the same way for the hash, a Decaying cell
+			// becomes Dead without its alive byte changing
+			uint32_t live = 0;
+			uint32_t died = 0;
+			uint32_t born = 0;
+			uint32_t changed = 0;
+			for (uint16_t x = start; x < end; x++)
+			{
+				const uint8_t now = rule.NextAlive(alive[x], neighbors[x]);
+				const Cell::State state = now ? Cell::State::Live : Cell::State::Dead;
+
+				nextrow[x] = state;
+				nextalive[x] = now;
+				live += now;
+				died += alive[x] & (now ^ 1);
+				born |= uint32_t{ now & (alive[x] ^ 1u) } << (x - start);
+				changed |= uint32_t{ state != row[x] } << (x - start);
+			}
+			local.live += live;
+			local.born += std::popcount(born);
+			local.dying += died;
+			local.dead += (end - start) - live;
+
+			if ((born != 0) || (died != 0))
+			{
+				tileChanged[tx] = 1;
+			}
+
+			while (born != 0)
+			{
+				_births[rowStart + start + std::countr_zero(born)] = gsl::narrow_cast<uint16_t>(_generation);
+				born &= born - 1;
+			}
+
+			while (_hashTracking && changed != 0)
+			{
+				const auto x = gsl::narrow_cast<uint16_t>(start + std::countr_zero(changed));
+				hashChanges ^= ZobristChange(rowStart + x, row[x], nextrow[x]);
+				changed &= changed - 1;
+			}
+		}
+	}
+
+	// one write per thread per generation, on the thread's own cache line
+	counts = local;
+	hash = hashChanges;
+}
+
+void Board::FillAliveRows(uint16_t startRow, uint16_t endRow) noexcept
+{
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const Cell::State* row = &_states[gsl::narrow_cast<size_t>(y) * _width];
+		uint8_t* alive = &_alive[PaddedIndex(0, y)];
+		for (uint16_t x = 0; x < _width; x++)
+		{
+			alive[x] = Cell::IsAlive(row[x]) ? 1 : 0;
+		}
+	}
+}
+
+namespace
+{
+	// the cell a halo cell at (x, y) copies, x from -1 to width and y from -1 to height, false if it stays dead
+	bool HaloSource(Topology topology, int width, int height, int& x, int& y) noexcept
+	{
+		const auto wrap = [](int v, int size) noexcept { return (v + size) % size; };
+		const bool acrossX = x < 0 || x >= width;
+		const bool acrossY = y < 0 || y >= height;
+
+		switch (topology)
+		{
+			case Topology::Torus:
+				break;
+
+			case Topology::KleinBottle:
+				// going over the top or bottom comes back mirrored
+				if (acrossY)
+				{
+					x = width - 1 - x;
+				}
+				break;
+
+			case Topology::CrossSurface:
+				if (acrossX && acrossY)
+				{
+					return false;
+				}
+				if (acrossY)
+				{
+					x = width - 1 - x;
+				}
+				if (acrossX)
+				{
+					y = height - 1 - y;
+				}
+				break;
+
+			case Topology::Bounded:
+			default:
+				return false;
+		}
+
+		x = wrap(x, width);
+		y = wrap(y, height);
+		return true;
+	}
+}
+
+void Board::BuildHalo()
+{
+	// every halo cell starts dead and is never a candidate, then the topology links some of them to the board
+	_halo.clear();
+	if (_alive.empty())
+	{
+		// not sized yet, Resize builds it
+		return;
+	}
+
+	const int width = _width;
+	const int height = _height;
+	const auto link = [this, width, height](int x, int y)
+		{
+			const auto halo = gsl::narrow_cast<uint32_t>((y + 1) * gsl::narrow_cast<int>(_stride) + (x + 1));
+			_alive[halo] = 0;
+			_nextalive[halo] = 0;
+			_candidate[halo] = 1;
+
+			if (width > 0 && height > 0 && HaloSource(_topology, width, height, x, y))
+			{
+				_halo.push_back({ halo, gsl::narrow_cast<uint32_t>(PaddedIndex(gsl::narrow_cast<uint16_t>(x), gsl::narrow_cast<uint16_t>(y))) });
+			}
+		};
+
+	for (int x = -1; x <= width; x++)
+	{
+		link(x, -1);
+		link(x, height);
+	}
+	for (int y = 0; y < height; y++)
+	{
+		link(-1, y);
+		link(width, y);
+	}
+
+	// sorted by the cell copied, so the incremental step can find a cell's copies
+	std::sort(_halo.begin(), _halo.end(), [](const HaloLink& a, const HaloLink& b) noexcept { return a.source < b.source; });
+}
+
+void Board::FillHalo() noexcept
+{
+	for (const HaloLink& link : _halo)
+	{
+		_alive[link.halo] = _alive[link.source];
+	}
+}
+
+void Board::FastDetermineNextState(const Rule& rule)
+{
+	ML_METHOD;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// the alive bytes are written along with each generation, they only need to be
+	// rebuilt when the board was edited or the last generation ran on the bits
+	if (!_aliveInSync)
+	{
+		_pool.RunRowRanges(Height(), [this](int, uint16_t startRow, uint16_t endRow)
+			{
+				FillAliveRows(startRow, endRow);
+			});
+		_aliveInSync = true;
+	}
+	FillHalo();
+
+	// a tile that settled under one rule may not be settled under another
+	if (!(rule == _tileRule))
+	{
+		_tilesInSync = false;
+		_tileRule = rule;
+	}
+	FindActiveTiles();
+	std::fill(_tileChanged.begin(), _tileChanged.end(), uint8_t{ 0 });
+
+	// split the board by rows of tiles so no tile is shared between threads
+	const auto stepStart = std::chrono::steady_clock::now();
+	_pool.RunRowRanges(_tilesDown, [this, &rule](int range, uint16_t startTileRow, uint16_t endTileRow)
+		{
+			const auto startRow = gsl::narrow_cast<uint16_t>(startTileRow * TileSize);
+			const auto endRow = gsl::narrow_cast<uint16_t>(std::min(endTileRow * TileSize, static_cast<int>(Height())));
+			UpdateRowsWithNextState(startRow, endRow, rule, _partialCounts[range], _partialHashes[range]);
+		});
+	const auto stepEnd = std::chrono::steady_clock::now();
+
+	ReducePartialCounts();
+	_tilesInSync = true;
+	// the neighbor plane now holds the counts this generation came from
+	_neighborsInSync = false;
+
+	// publish the new generation
+	_states.swap(_nextstates);
+	_alive.swap(_nextalive);
+	_generation++;
+
+	RecordPhaseTimes(start, stepStart, stepEnd);
+}
+
+void Board::RecordPhaseTimes(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stepStart, std::chrono::steady_clock::time_point stepEnd, uint32_t generations) noexcept
+{
+	_phaseTimes.prepare += stepStart - start;
+	_phaseTimes.step += stepEnd - stepStart;
+	_phaseTimes.publish += std::chrono::steady_clock::now() - stepEnd;
+	_phaseTimes.generations += generations;
+}
+
+void Board::BlockedNextState(const Rule& rule, uint16_t generations)
+{
+	ML_METHOD;
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!_aliveInSync)
+	{
+		_pool.RunRowRanges(Height(), [this](int, uint16_t startRow, uint16_t endRow)
+			{
+				FillAliveRows(startRow, endRow);
+			});
+		_aliveInSync = true;
+	}
+	_blockScratch.resize(_threadcount);
+
+	// split the board by rows of blocks, each block is read from the current generation and written to the next one
+	const auto blocksAcross = gsl::narrow_cast<uint16_t>((_width + BlockSize - 1) / BlockSize);
+	const auto blocksDown = gsl::narrow_cast<uint16_t>((_height + BlockSize - 1) / BlockSize);
+	const auto stepStart = std::chrono::steady_clock::now();
+	_pool.RunRowRanges(blocksDown, [this, &rule, generations, blocksAcross](int range, uint16_t startBlockRow, uint16_t endBlockRow)
+		{
+			GenerationCounts local;
+			uint64_t hash = 0;
+			for (uint16_t by = startBlockRow; by < endBlockRow; by++)
+			{
+				for (uint16_t bx = 0; bx < blocksAcross; bx++)
+				{
+					StepBlock(bx, by, rule, generations, _blockScratch[range], local, hash);
+				}
+			}
+			_partialCounts[range] = local;
+			_partialHashes[range] = hash;
+		});
+	const auto stepEnd = std::chrono::steady_clock::now();
+
+	ReducePartialCounts();
+
+	// publish the last of the generations, the ones in between were never on the board
+	_states.swap(_nextstates);
+	_alive.swap(_nextalive);
+	_generation += generations;
+	_bitsInSync = false;
+	_planesInSync = false;
+	_tilesInSync = false;
+	_neighborsInSync = false;
+	_activeTiles = GetTileCount();
+
+	RecordPhaseTimes(start, stepStart, stepEnd, generations);
+}
+
+bool Board::BlockSource(int& x, int& y) const noexcept
+{
+	// like HaloSource, for cells any distance past the edge
+	const auto wrap = [](int v, int size) noexcept { return ((v % size) + size) % size; };
+	switch (_topology)
+	{
+		case Topology::Torus:
+			break;
+
+		case Topology::KleinBottle:
+			// every trip over the top or bottom mirrors the row, two trips put it back
+			if (((y < 0) ? ((-y - 1) / _height) + 1 : y / _height) % 2 == 1)
+			{
+				x = _width - 1 - x;
+			}
+			break;
+
+		case Topology::Bounded:
+		default:
+			return x >= 0 && x < _width && y >= 0 && y < _height;
+	}
+
+	x = wrap(x, _width);
+	y = wrap(y, _height);
+	return true;
+}
+
+void Board::StepBlock(uint16_t bx, uint16_t by, const Rule& rule, uint16_t generations, BlockScratch& scratch, GenerationCounts& counts, uint64_t& hash)
+{
+	const int border = generations;
+	const int x0 = bx * BlockSize;
+	const int y0 = by * BlockSize;
+	const int blockWidth = std::min<int>(BlockSize, _width - x0);
+	const int blockHeight = std::min<int>(BlockSize, _height - y0);
+	const int sw = blockWidth + (2 * border);
+	const int sh = blockHeight + (2 * border);
+	const size_t area = gsl::narrow_cast<size_t>(sw) * sh;
+
+	scratch.current.resize(area);
+	scratch.next.resize(area);
+	scratch.counts.resize(area);
+	scratch.bornAt.assign(area, 0);
+
+	// copy the block and the border, the cells past the edge of the board come from wherever the topology puts them
+	for (int sy = 0; sy < sh; sy++)
+	{
+		uint8_t* row = &scratch.current[gsl::narrow_cast<size_t>(sy) * sw];
+		const int y = y0 - border + sy;
+		const int xStart = x0 - border;
+		if (y >= 0 && y < _height && xStart >= 0 && xStart + sw <= _width)
+		{
+			std::copy_n(&_alive[PaddedIndex(gsl::narrow_cast<uint16_t>(xStart), gsl::narrow_cast<uint16_t>(y))], sw, row);
+			continue;
+		}
+
+		for (int sx = 0; sx < sw; sx++)
+		{
+			int x = xStart + sx;
+			int sourceY = y;
+			row[sx] = BlockSource(x, sourceY) ? _alive[PaddedIndex(gsl::narrow_cast<uint16_t>(x), gsl::narrow_cast<uint16_t>(sourceY))] : 0;
+		}
+	}
+
+	// on a bounded board the cells past the edge stay dead, so only the part on the board is stepped,
+	// and the rest has to be dead in both buffers
+	const bool bounded = _topology == Topology::Bounded;
+	const int boardLeft = std::max(0, border - x0);
+	const int boardRight = std::min(sw, _width - x0 + border);
+	const int boardTop = std::max(0, border - y0);
+	const int boardBottom = std::min(sh, _height - y0 + border);
+	if (bounded)
+	{
+		scratch.next = scratch.current;
+	}
+
+	uint8_t* current = scratch.current.data();
+	uint8_t* next = scratch.next.data();
+	uint8_t* neighbors = scratch.counts.data();
+	uint8_t* bornAt = scratch.bornAt.data();
+
+	GenerationCounts local;
+	for (int step = 1; step <= generations; step++)
+	{
+		int left = step;
+		int right = sw - step;
+		int top = step;
+		int bottom = sh - step;
+		if (bounded)
+		{
+			left = std::max(left, boardLeft);
+			right = std::min(right, boardRight);
+			top = std::max(top, boardTop);
+			bottom = std::min(bottom, boardBottom);
+		}
+
+		// the last step is the generation that ends up on the board, so it's the one counted
+		const bool last = step == generations;
+		const auto stepByte = gsl::narrow_cast<uint8_t>(step);
+		for (int r = top; r < bottom; r++)
+		{
+			const size_t rowStart = gsl::narrow_cast<size_t>(r) * sw;
+			const auto start = gsl::narrow_cast<uint16_t>(left);
+			const auto end = gsl::narrow_cast<uint16_t>(right);
+			_kernel.CountPaddedSpan(current + rowStart - sw, current + rowStart, current + rowStart + sw, neighbors + rowStart, start, end);
+			_kernel.NextAliveSpan(current + rowStart, neighbors + rowStart, next + rowStart, start, end, rule.AliveTable());
+
+			// no branches, so the compiler can vectorize it
+			for (size_t i = rowStart + left; i < rowStart + right; i++)
+			{
+				const uint8_t born = next[i] & (current[i] ^ 1);
+				bornAt[i] = born ? stepByte : bornAt[i];
+			}
+
+			if (last)
+			{
+				for (size_t i = rowStart + left; i < rowStart + right; i++)
+				{
+					local.live += next[i];
+					local.born += next[i] & (current[i] ^ 1u);
+					local.dying += current[i] & (next[i] ^ 1u);
+				}
+			}
+		}
+		std::swap(current, next);
+	}
+
+	// write the block back, with the counts its last generation came from and the generation each new cell was born in
+	for (int r = border; r < border + blockHeight; r++)
+	{
+		const auto y = gsl::narrow_cast<uint16_t>(y0 + r - border);
+		const size_t first = gsl::narrow_cast<size_t>(r) * sw + border;
+		const size_t padded = PaddedIndex(gsl::narrow_cast<uint16_t>(x0), y);
+		const size_t index = gsl::narrow_cast<size_t>(y) * _width + x0;
+
+		std::copy_n(current + first, blockWidth, &_nextalive[padded]);
+		std::copy_n(neighbors + first, blockWidth, &_neighbors[padded]);
+		for (int c = 0; c < blockWidth; c++)
+		{
+			const uint8_t alive = current[first + c];
+			const Cell::State state = alive ? Cell::State::Live : Cell::State::Dead;
+			_nextstates[index + c] = state;
+			if (_hashTracking && state != _states[index + c])
+			{
+				hash ^= ZobristChange(index + c, _states[index + c], state);
+			}
+			if (alive && bornAt[first + c] != 0)
+			{
+				_births[index + c] = gsl::narrow_cast<uint16_t>(_generation + bornAt[first + c] - 1);
+			}
+		}
+	}
+
+	local.dead = gsl::narrow_cast<uint32_t>(blockWidth * blockHeight) - local.live;
+	counts += local;
+}
+
+void Board::FindActiveTiles() noexcept
+{
+	// after an edit or a FastConway generation there's no history, so every tile is active
+	if (!_tilesInSync)
+	{
+		std::fill(_tileActive.begin(), _tileActive.end(), uint8_t{ 1 });
+		_activeTiles = GetTileCount();
+		return;
+	}
+
+	// a tile is active if it or any of its 8 neighbors changed, wrapping like the torus,
+	// which for a bounded board only adds a few tiles
+	const bool mirrored = _topology == Topology::KleinBottle || _topology == Topology::CrossSurface;
+	_activeTiles = 0;
+	for (uint16_t ty = 0; ty < _tilesDown; ty++)
+	{
+		const uint16_t tyabove = (ty == 0) ? _tilesDown - 1 : ty - 1;
+		const uint16_t tybelow = (ty == _tilesDown - 1) ? 0 : ty + 1;
+
+		for (uint16_t tx = 0; tx < _tilesAcross; tx++)
+		{
+			const uint16_t txleft = (tx == 0) ? _tilesAcross - 1 : tx - 1;
+			const uint16_t txright = (tx == _tilesAcross - 1) ? 0 : tx + 1;
+
+			uint8_t active = 0;
+			for (const uint16_t y : { tyabove, ty, tybelow })
+			{
+				const uint8_t* changed = &_tileChanged[y * _tilesAcross];
+				active |= changed[txleft] | changed[tx] | changed[txright];
+			}
+
+			// across a mirrored edge the neighboring tiles aren't the ones next door, so the edge tiles are always computed
+			if (mirrored && (ty == 0 || ty == _tilesDown - 1 || tx == 0 || tx == _tilesAcross - 1))
+			{
+				active = 1;
+			}
+
+			_tileActive[ty * _tilesAcross + tx] = active;
+			_activeTiles += active;
+		}
+	}
+}
+
+void Board::LoadNeighbors()
+{
+	// B/S rules only know Live and Dead, the same as the bit-packed board
+	_pool.RunRowRanges(Height(), [this](int range, uint16_t startRow, uint16_t endRow)
+		{
+			uint32_t live = 0;
+			uint64_t hash = 0;
+			for (uint16_t y = startRow; y < endRow; y++)
+			{
+				const size_t rowStart = gsl::narrow_cast<size_t>(y) * _width;
+				Cell::State* row = &_states[rowStart];
+				uint8_t* alive = &_alive[PaddedIndex(0, y)];
+				for (uint16_t x = 0; x < _width; x++)
+				{
+					const bool now = Cell::IsAlive(row[x]);
+					const Cell::State state = now ? Cell::State::Live : Cell::State::Dead;
+					if (row[x] != state)
+					{
+						hash ^= ZobristChange(rowStart + x, row[x], state);
+						row[x] = state;
+					}
+					alive[x] = now ? 1 : 0;
+					live += now ? 1 : 0;
+				}
+			}
+			_partialCounts[range].live = live;
+			_partialHashes[range] = hash;
+		});
+	FillHalo();
+
+	_pool.RunRowRanges(Height(), [this](int, uint16_t startRow, uint16_t endRow)
+		{
+			for (uint16_t y = startRow; y < endRow; y++)
+			{
+				const uint8_t* alive = &_alive[PaddedIndex(0, y)];
+				_kernel.CountPaddedSpan(alive - _stride, alive, alive + _stride, &_neighbors[PaddedIndex(0, y)], 0, Width());
+			}
+		});
+
+	ReducePartialCounts();
+	_liveCells = _counts.live;
+
+	// nothing is known about the last generation, so every cell is a candidate
+	for (const uint32_t padded : _candidates)
+	{
+		_candidate[padded] = 0;
+	}
+	_candidates.clear();
+	_allCandidates = true;
+	_aliveInSync = true;
+	_neighborsInSync = true;
+}
+
+void Board::FindChanges(size_t first, size_t last, const Rule& rule, std::vector<uint32_t>& changes) const
+{
+	for (size_t k = first; k < last; k++)
+	{
+		const uint32_t padded = _candidates[k];
+		if (rule.NextAlive(_alive[padded], _neighbors[padded]) != _alive[padded])
+		{
+			changes.push_back(padded);
+		}
+	}
+}
+
+void Board::FindChangesRows(uint16_t startRow, uint16_t endRow, const Rule& rule, std::vector<uint32_t>& changes) const
+{
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const auto first = gsl::narrow_cast<uint32_t>(PaddedIndex(0, y));
+		for (uint32_t padded = first; padded < first + _width; padded++)
+		{
+			if (rule.NextAlive(_alive[padded], _neighbors[padded]) != _alive[padded])
+			{
+				changes.push_back(padded);
+			}
+		}
+	}
+}
+
+void Board::ApplyChange(uint32_t padded) noexcept
+{
+	const bool born = _alive[padded] == 0;
+	const size_t index = StateIndex(padded);
+
+	const Cell::State state = born ? Cell::State::Live : Cell::State::Dead;
+	_hash ^= ZobristChange(index, _states[index], state);
+	_alive[padded] = born ? 1 : 0;
+	_states[index] = state;
+	if (born)
+	{
+		_births[index] = gsl::narrow_cast<uint16_t>(_generation);
+	}
+
+	// uint8_t wraps, so a death adds 255
+	const uint8_t delta = born ? 1 : 0xFF;
+	AddDeltas(padded, delta);
+	AddCandidate(padded);
+
+	// a cell on the edge also has copies in the halo, and the cells around a copy count it too
+	const auto copies = std::equal_range(_halo.begin(), _halo.end(), HaloLink{ 0, padded }, [](const HaloLink& a, const HaloLink& b) noexcept { return a.source < b.source; });
+	for (auto link = copies.first; link != copies.second; ++link)
+	{
+		_alive[link->halo] = _alive[padded];
+		AddDeltas(link->halo, delta);
+	}
+}
+
+void Board::AddDeltas(uint32_t padded, uint8_t delta) noexcept
+{
+	// the halo is always marked as listed, so only real cells become candidates
+	// around a halo cell some neighbors are off the plane (the unsigned index wraps to a big one), and they aren't cells anyway
+	const auto size = gsl::narrow_cast<uint32_t>(_neighbors.size());
+	for (const uint32_t neighbor : { padded - _stride - 1, padded - _stride, padded - _stride + 1, padded - 1, padded + 1, padded + _stride - 1, padded + _stride, padded + _stride + 1 })
+	{
+		if (neighbor < size)
+		{
+			_neighbors[neighbor] += delta;
+			AddCandidate(neighbor);
+		}
+	}
+}
+
+void Board::IncrementalNextState(const Rule& rule)
+{
+	ML_METHOD;
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!_neighborsInSync)
+	{
+		LoadNeighbors();
+	}
+
+	// a cell that was stable under another rule may not be under this one
+	if (!(rule == _incrementalRule))
+	{
+		_incrementalRule = rule;
+		_allCandidates = true;
+	}
+
+	// every thread looks at its share of the candidates and lists the ones that change,
+	// nothing is written so all of them see the same generation
+	const auto stepStart = std::chrono::steady_clock::now();
+	for (auto& changes : _partialChanges)
+	{
+		changes.clear();
+	}
+	if (_allCandidates)
+	{
+		_pool.RunRowRanges(Height(), [this, &rule](int range, uint16_t startRow, uint16_t endRow)
+			{
+				FindChangesRows(startRow, endRow, rule, _partialChanges[range]);
+			});
+	}
+	else
+	{
+		const size_t candidates = _candidates.size();
+		const auto ranges = gsl::narrow_cast<uint16_t>(_threadcount);
+		_pool.RunRowRanges(ranges, [this, &rule, candidates, ranges](int range, uint16_t startRange, uint16_t endRange)
+			{
+				FindChanges(candidates * startRange / ranges, candidates * endRange / ranges, rule, _partialChanges[range]);
+			});
+	}
+	const auto stepEnd = std::chrono::steady_clock::now();
+
+	// apply the changes in place, which lists the candidates for the next generation
+	for (const uint32_t padded : _candidates)
+	{
+		_candidate[padded] = 0;
+	}
+	_nextCandidates.clear();
+
+	uint32_t born = 0;
+	uint32_t died = 0;
+	for (const auto& changes : _partialChanges)
+	{
+		for (const uint32_t padded : changes)
+		{
+			if (_alive[padded])
+			{
+				died++;
+			}
+			else
+			{
+				born++;
+			}
+			ApplyChange(padded);
+		}
+	}
+	_candidates.swap(_nextCandidates);
+	_allCandidates = false;
+
+	_liveCells = _liveCells + born - died;
+	_counts = {};
+	_counts.live = _liveCells;
+	_counts.born = born;
+	_counts.dying = died;
+	_counts.dead = Size() - _liveCells;
+
+	// the states changed without the double buffer, so the step and the bit-packed paths start over
+	_bitsInSync = false;
+	_planesInSync = false;
+	_tilesInSync = false;
+	_activeTiles = 0;
+	_generation++;
+
+	RecordPhaseTimes(start, stepStart, stepEnd);
+}
+
+void Board::LoadBitBoard()
+{
+	// only Live and Dead exist on the bit-packed board, so any other state collapses to one of them
+	for (uint16_t y = 0; y < Height(); y++)
+	{
+		for (uint16_t x = 0; x < Width(); x++)
+		{
+			const size_t index = x + (y * _width);
+			Cell::State& state = _states[index];
+			const bool alive = Cell::IsAlive(state);
+			const Cell::State collapsed = alive ? Cell::State::Live : Cell::State::Dead;
+			if (state != collapsed)
+			{
+				_hash ^= ZobristChange(index, state, collapsed);
+				state = collapsed;
+			}
+			_bits.Set(x, y, alive);
+		}
+	}
+	_bitsInSync = true;
+}
+
+void Board::BitwiseConwayNextState()
+{
+	ML_METHOD;
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!_bitsInSync)
+	{
+		LoadBitBoard();
+	}
+
+	// each thread computes its rows of the next generation and then writes the matching states
+	// the step only reads the current bits and the apply only writes the next states, so no row is shared between threads
+	const auto stepStart = std::chrono::steady_clock::now();
+	_pool.RunRowRanges(Height(), [this](int range, uint16_t startRow, uint16_t endRow)
+		{
+			_bits.StepConwayRows(startRow, endRow);
+			ApplyBitRows(startRow, endRow, _partialCounts[range], _partialHashes[range]);
+		});
+	const auto stepEnd = std::chrono::steady_clock::now();
+
+	ReducePartialCounts();
+
+	_bits.Swap();
+	_states.swap(_nextstates);
+	_planesInSync = false;
+	_aliveInSync = false;
+	_tilesInSync = false;
+	_neighborsInSync = false;
+	_activeTiles = GetTileCount();
+	_generation++;
+
+	RecordPhaseTimes(start, stepStart, stepEnd);
+}
+
+void Board::ApplyBitRows(uint16_t startRow, uint16_t endRow, GenerationCounts& counts, uint64_t& hash)
+{
+	GenerationCounts local;
+	uint64_t hashChanges = 0;
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const uint64_t* current = _bits.Row(y);
+		const uint64_t* next = _bits.NextRow(y);
+
+		// start from the current generation, then only touch the cells whose bits say they changed
+		const size_t rowStart = gsl::narrow_cast<size_t>(y) * _width;
+		std::copy_n(&_states[rowStart], _width, &_nextstates[rowStart]);
+
+		for (uint16_t k = 0; k < _bits.WordsPerRow(); k++)
+		{
+			const size_t first = rowStart + (k * 64);
+			Cell::State* states = &_nextstates[first];
+
+			local.live += std::popcount(next[k]);
+			local.born += std::popcount(next[k] & ~current[k]);
+			local.dying += std::popcount(current[k] & ~next[k]);
+
+			// walk only the set bits, so dead areas of the board cost nothing
+			// cells that survive get older by themselves
+			uint64_t born = next[k] & ~current[k];
+			while (born != 0)
+			{
+				const int b = std::countr_zero(born);
+				hashChanges ^= _hashTracking ? ZobristChange(first + b, states[b], Cell::State::Live) : 0;
+				states[b] = Cell::State::Live;
+				_births[first + b] = gsl::narrow_cast<uint16_t>(_generation);
+				born &= born - 1;
+			}
+
+			uint64_t died = current[k] & ~next[k];
+			while (died != 0)
+			{
+				const int b = std::countr_zero(died);
+				hashChanges ^= _hashTracking ? ZobristChange(first + b, states[b], Cell::State::Dead) : 0;
+				states[b] = Cell::State::Dead;
+				died &= died - 1;
+			}
+		}
+	}
+
+	local.dead = gsl::narrow_cast<uint32_t>((endRow - startRow) * _width) - local.live;
+	counts = local;
+	hash = hashChanges;
+}
+
+void Board::LoadPlanes(uint16_t states)
+{
+	// every decaying Cell looks the same, its stage comes from the generation it started decaying,
+	// and a stage the rule doesn't have (after a switch to fewer states) is the last one
+	_planes.Resize(Width(), Height(), states);
+	for (uint16_t y = 0; y < Height(); y++)
+	{
+		for (uint16_t x = 0; x < Width(); x++)
+		{
+			const Cell::State state = StateAt(x, y);
+			if (state == Cell::State::Decaying)
+			{
+				const size_t index = x + (y * _width);
+				const auto decayed = gsl::narrow_cast<uint16_t>(gsl::narrow_cast<uint16_t>(_generation) - _births[index]);
+				const int stage = std::clamp(decayed + 1, 2, states - 1);
+				_planes.Set(x, y, gsl::narrow_cast<uint8_t>(stage));
+			}
+			else if (Cell::IsAlive(state))
+			{
+				_planes.Set(x, y, 1);
+			}
+		}
+	}
+	_planesInSync = true;
+}
+
+void Board::GenerationsNextState(const Rule& rule)
+{
+	ML_METHOD;
+
+	const auto start = std::chrono::steady_clock::now();
+	if (!_planesInSync || _planes.States() != rule.States())
+	{
+		LoadPlanes(rule.States());
+	}
+
+	// same as BitwiseConwayNextState, each thread steps its rows of the planes and then writes the matching states
+	const auto stepStart = std::chrono::steady_clock::now();
+	_pool.RunRowRanges(Height(), [this, &rule](int range, uint16_t startRow, uint16_t endRow)
+		{
+			_planes.StepRows(startRow, endRow, rule);
+			ApplyPlaneRows(startRow, endRow, _partialCounts[range], _partialHashes[range]);
+		});
+	const auto stepEnd = std::chrono::steady_clock::now();
+
+	ReducePartialCounts();
+
+	_planes.Swap();
+	_states.swap(_nextstates);
+	_bitsInSync = false;
+	_aliveInSync = false;
+	_tilesInSync = false;
+	_neighborsInSync = false;
+	_activeTiles = GetTileCount();
+	_generation++;
+
+	RecordPhaseTimes(start, stepStart, stepEnd);
+}
+
+void Board::ApplyPlaneRows(uint16_t startRow, uint16_t endRow, GenerationCounts& counts, uint64_t& hash)
+{
+	const uint16_t wordsPerRow = _planes.WordsPerRow();
+
+	GenerationCounts local;
+	uint64_t hashChanges = 0;
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const uint64_t* current = _planes.AliveRow(y);
+		const uint64_t* next = _planes.NextAliveRow(y);
+		const uint64_t* currentPlanes = _planes.Row(y);
+		const uint64_t* nextPlanes = _planes.NextRow(y);
+
+		// start from the current generation, then only touch the cells whose state changed
+		const size_t rowStart = gsl::narrow_cast<size_t>(y) * _width;
+		std::copy_n(&_states[rowStart], _width, &_nextstates[rowStart]);
+
+		for (uint16_t k = 0; k < wordsPerRow; k++)
+		{
+			const size_t first = rowStart + (k * 64);
+			Cell::State* states = &_nextstates[first];
+
+			uint64_t currentOccupied = 0;
+			uint64_t nextOccupied = 0;
+			for (uint16_t p = 0; p < _planes.PlaneCount(); p++)
+			{
+				currentOccupied |= currentPlanes[p * wordsPerRow + k];
+				nextOccupied |= nextPlanes[p * wordsPerRow + k];
+			}
+			const uint64_t currentDecaying = currentOccupied & ~current[k];
+			const uint64_t nextDecaying = nextOccupied & ~next[k];
+
+			local.live += std::popcount(next[k]);
+			local.born += std::popcount(next[k] & ~current[k]);
+			local.dying += std::popcount(nextDecaying);
+
+			uint64_t born = next[k] & ~current[k];
+			while (born != 0)
+			{
+				const int b = std::countr_zero(born);
+				hashChanges ^= _hashTracking ? ZobristChange(first + b, states[b], Cell::State::Live) : 0;
+				states[b] = Cell::State::Live;
+				_births[first + b] = gsl::narrow_cast<uint16_t>(_generation);
+				born &= born - 1;
+			}
+
+			// CellAge gives decaying cells the oldest color, so their births can keep when they started decaying
+			uint64_t decayed = nextDecaying & ~currentDecaying;
+			while (decayed != 0)
+			{
+				const int b = std::countr_zero(decayed);
+				hashChanges ^= _hashTracking ? ZobristChange(first + b, states[b], Cell::State::Decaying) : 0;
+				states[b] = Cell::State::Decaying;
+				_births[first + b] = gsl::narrow_cast<uint16_t>(_generation);
+				decayed &= decayed - 1;
+			}
+
+			uint64_t died = currentOccupied & ~nextOccupied;
+			while (died != 0)
+			{
+				const int b = std::countr_zero(died);
+				hashChanges ^= _hashTracking ? ZobristChange(first + b, states[b], Cell::State::Dead) : 0;
+				states[b] = Cell::State::Dead;
+				died &= died - 1;
+			}
+		}
+	}
+
+	local.dead = gsl::narrow_cast<uint32_t>((endRow - startRow) * _width) - local.live - local.dying;
+	counts = local;
+	hash = hashChanges;
 }
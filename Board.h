@@ -1,5 +1,9 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <mutex>
 #include <vector>
 
@@ -7,6 +11,12 @@
 
 #include "Shape.h"
 #include "Cell.h"
+#include "Rule.h"
+#include "BitBoard.h"
+#include "GenerationsBitBoard.h"
+#include "NeighborKernel.h"
+#include "ThreadPool.h"
+#include "Xoshiro.h"
 
 struct GridPoint
 {
@@ -19,24 +29,94 @@ struct GridPoint
     }
 };
 
-enum class BoardRules : uint8_t
+// how the edges of the board meet
+// Torus wraps both ways, Bounded has dead cells all around, KleinBottle wraps left to right and flips the
+// top and bottom over, CrossSurface flips both (the corners of a CrossSurface have no diagonal neighbor, they read as dead)
+// B/S rules honor every topology, FastConway runs on the B/S path for anything but the torus,
+// and the Generations rules always wrap like the torus
+enum class Topology : uint8_t
 {
-    FastConway = 1,
-    Conway,
-    DayAndNight,
-    LifeWithoutDeath,
-    BriansBrain,
-    Seeds,
-    Highlife
+    Torus,
+    Bounded,
+    KleinBottle,
+    CrossSurface
+};
+
+// cell counts for one generation
+// each thread counts its own rows into its own GenerationCounts, on its own cache line,
+// and the board adds them up once when the generation is done
+struct alignas(64) GenerationCounts
+{
+    uint32_t live{ 0 };
+    uint32_t born{ 0 };
+    uint32_t dying{ 0 };
+    uint32_t dead{ 0 };
+    uint32_t old{ 0 };
+
+    GenerationCounts& operator+=(const GenerationCounts& other) noexcept
+    {
+        live += other.live;
+        born += other.born;
+        dying += other.dying;
+        dead += other.dead;
+        old += other.old;
+        return *this;
+    }
+};
+
+// what the board does once it finds itself repeating
+// Detect only reports the cycle, Pause stops the board there, Replay plays the recorded cycle back instead of computing it
+enum class CycleAction : uint8_t
+{
+    Off,
+    Detect,
+    Pause,
+    Replay
+};
+
+// a board that repeats, period is 0 until one is found and 1 for a still life
+// start is the earliest generation the history shows in the cycle
+struct CycleInfo
+{
+    uint32_t period{ 0 };
+    uint32_t start{ 0 };
+};
+
+// time spent in each phase of Update, added up over generations
+// prepare rebuilds whatever the step reads (bits, planes, alive bytes, active tiles),
+// step counts neighbors, applies the rule and writes the next generation in one pass on every thread,
+// publish adds up the counts and swaps the generations
+struct PhaseTimes
+{
+    std::chrono::nanoseconds prepare{ 0 };
+    std::chrono::nanoseconds step{ 0 };
+    std::chrono::nanoseconds publish{ 0 };
+    uint64_t generations{ 0 };
+};
+
+// one generation as the renderer draws it, copied out so the board can go on to the next while it's drawn
+// a cell's sprite is its age, capped at the oldest color, or NotDrawn for cells that aren't drawn
+struct BoardSnapshot
+{
+    static constexpr uint16_t NotDrawn{ 0xFFFF };
+
+    uint16_t width{ 0 };
+    uint16_t height{ 0 };
+    uint32_t generation{ 0 };
+    uint32_t liveCount{ 0 };
+    CycleInfo cycle;
+    std::vector<uint16_t> sprites;
 };
 
 // for visualization purposes (0,0) is the top left.
 // as x increases move right, as y increases move down
+// the cells are stored as separate planes (state, neighbor count, birth generation) instead of an array of Cell,
+// so each pass only pulls the bytes it needs through the cache; GetCell puts a Cell back together
 class Board
 {
   public:
 
-    Board() noexcept;
+    Board();
     ~Board() = default;
 
     // move/copy constuct
@@ -47,25 +127,32 @@ class Board
     Board& operator=(Board&& b) = delete;
     Board& operator=(Board& b) = delete;
 
-    [[nodiscard]] const Cell& GetCell(uint16_t x, uint16_t y) const
+    // a copy, changing it doesn't change the board
+    [[nodiscard]] Cell GetCell(uint16_t x, uint16_t y) const
     {
-        return _cells.at(x + (y * _width));
-    }
-
-    [[nodiscard]] Cell& GetCell(uint16_t x, uint16_t y)
-    {
-        return _cells.at(x + (y * _width));
+        const size_t index = x + (y * _width);
+        return Cell{ _states.at(index), _neighbors[PaddedIndex(x, y)], CellAge(index) };
     }
 
     [[nodiscard]] bool Alive(uint16_t x, uint16_t y) const noexcept
     {
-        return GetCell(x,y).GetState() != Cell::State::Dead;
+        return _states[x + (y * _width)] != Cell::State::Dead;
     }
 
     void Resize(uint16_t width, uint16_t height, uint16_t maxage);
+    // a new random board every call
     void RandomizeBoard(float alivepct, uint16_t maxage);
+    // the same seed gives the same board, whatever the thread count
+    void RandomizeBoard(float alivepct, uint16_t maxage, uint64_t seed);
+    void Clear();
     void TurnCellOn(GridPoint g, bool on);
     void Update(BoardRules rules);
+    void Update(const Rule& rule);
+    // runs generations generations, each block of the board TemporalBlock() of them at a time
+    void Update(const Rule& rule, uint32_t generations);
+    // the same for a preset, FastConway runs them one at a time on the bit-packed board, which beats the blocks
+    void Update(BoardRules rules, uint32_t generations);
+    // the part of the shape that's past the board's edges is clipped off, false if any was
     bool CopyShape(Shape& shape, uint16_t startX, uint16_t startY);
     void PrintBoard();
 
@@ -92,27 +179,27 @@ class Board
 
     [[nodiscard]] uint32_t GetDeadCount() const noexcept
     {
-        return _numDead;
+        return _counts.dead;
     }
 
     [[nodiscard]] uint32_t GetLiveCount() const noexcept
     {
-        return _numLive;
+        return _counts.live;
     }
 
     [[nodiscard]] uint32_t GetBornCount() const noexcept
     {
-        return _numBorn;
+        return _counts.born;
     }
 
     [[nodiscard]] uint32_t GetOldCount() const noexcept
     {
-        return _numOld;
+        return _counts.old;
     }
 
     [[nodiscard]] uint32_t GetDyingCount() const noexcept
     {
-        return _numDying;
+        return _counts.dying;
     }
 
     [[nodiscard]] uint32_t Generation() const noexcept
@@ -135,51 +222,461 @@ class Board
         return _height * _width;
     }
 
+    // B/S rules can keep every cell's neighbor count from one generation to the next instead of recounting,
+    // then only the cells next to a birth or a death are looked at again, so a quiet board costs little
+    // a busy board is faster without it
+    void IncrementalNeighbors(bool enabled) noexcept
+    {
+        _incremental = enabled;
+    }
+
+    [[nodiscard]] bool IncrementalNeighbors() const noexcept
+    {
+        return _incremental;
+    }
+
+    // how many generations Update(rule, generations) runs on one block before moving on to the next,
+    // 1 runs them one at a time across the whole board
+    void TemporalBlock(uint16_t generations) noexcept
+    {
+        _blockGenerations = std::clamp(generations, uint16_t{ 1 }, MaxTemporalBlock);
+    }
+
+    [[nodiscard]] uint16_t TemporalBlock() const noexcept
+    {
+        return _blockGenerations;
+    }
+
+    static constexpr uint16_t MaxTemporalBlock{ 32 };
+
+    void SetTopology(Topology topology);
+
+    // every generation is hashed and compared with the last CycleHistory, a repeat within MaxCyclePeriod generations
+    // is checked cell for cell once the generations up to the next repeat have been recorded
+    // Generations rules with more than 3 states aren't tracked, their decay stages all look the same in the states
+    void CycleDetection(CycleAction action) noexcept
+    {
+        _cycleAction = action;
+        ForgetCycle();
+    }
+
+    [[nodiscard]] CycleAction CycleDetection() const noexcept
+    {
+        return _cycleAction;
+    }
+
+    [[nodiscard]] const CycleInfo& GetCycle() const noexcept
+    {
+        return _cycle;
+    }
+
+    [[nodiscard]] bool IsPaused() const noexcept
+    {
+        return _cycle.period != 0 && _cycleAction == CycleAction::Pause;
+    }
+
+    static constexpr uint32_t MaxCyclePeriod{ 32 };
+    static constexpr size_t CycleHistory{ 64 };
+
+    [[nodiscard]] Topology GetTopology() const noexcept
+    {
+        return _topology;
+    }
+
+    // a Zobrist hash of the states: the XOR of a key for every cell that isn't dead
+    // with tracking on, every generation and edit XORs in the keys of the cells it changes, so Hash costs nothing;
+    // with it off, Hash goes over the whole board
+    void HashTracking(bool enabled) noexcept
+    {
+        _hashTracking = enabled;
+        _hashInSync = false;
+    }
+
+    [[nodiscard]] bool HashTracking() const noexcept
+    {
+        return _hashTracking;
+    }
+
+    [[nodiscard]] uint64_t Hash();
+
+    // the same hash from scratch, to check the tracked one against
+    [[nodiscard]] uint64_t ComputeHash();
+
+    // copies the current generation into the snapshot, reusing its memory
+    void Snapshot(BoardSnapshot& snapshot);
+
+    // rewinding: the board is remembered before every generation, all of it every RewindKeyframes generations
+    // and only the cells that changed in between, and the oldest keyframe and what follows it go once
+    // more than the memory cap is used; a cap of 0 turns it off
+    // Update runs temporal blocks one generation at a time while it's on, so every generation can be gone back to
+    void RewindMemory(size_t bytes);
+
+    [[nodiscard]] size_t RewindMemory() const noexcept
+    {
+        return _rewindCap;
+    }
+
+    void RewindKeyframes(uint32_t generations) noexcept
+    {
+        _rewindKeyframes = std::max(generations, 1u);
+    }
+
+    [[nodiscard]] uint32_t RewindKeyframes() const noexcept
+    {
+        return _rewindKeyframes;
+    }
+
+    // the frames and the copy of the board the next frame is compared with
+    [[nodiscard]] size_t RewindMemoryUsed() const noexcept
+    {
+        return _rewindBytes + (_rewindStates.size() * sizeof(Cell::State)) + (_rewindBirths.size() * sizeof(uint16_t));
+    }
+
+    // the remembered generations, the newest is the last one computed from when the board moves back
+    [[nodiscard]] uint32_t OldestGeneration() const noexcept
+    {
+        return _rewindFrames.empty() ? _generation : _rewindFrames.front().generation;
+    }
+
+    [[nodiscard]] uint32_t NewestGeneration() const noexcept
+    {
+        return _rewindFrames.empty() ? _generation : std::max(_rewindFrames.back().generation, _generation);
+    }
+
+    // puts the board back the given number of generations, or at a remembered generation, back or forward
+    // the generations after it stay until the board computes a new one from there, so they can be scrubbed through
+    // false, and nothing changes, if the generation isn't remembered
+    bool Rewind(uint32_t generations);
+    bool SeekGeneration(uint32_t generation);
+
+    // threadcount includes the calling thread
+    void ThreadCount(int threadcount);
+
+    [[nodiscard]] int ThreadCount() const noexcept
+    {
+        return _threadcount;
+    }
+
+    [[nodiscard]] const PhaseTimes& GetPhaseTimes() const noexcept
+    {
+        return _phaseTimes;
+    }
+
+    void ResetPhaseTimes() noexcept
+    {
+        _phaseTimes = {};
+    }
+
+    // the board is divided into TileSize x TileSize tiles for activity tracking
+    // a tile is only recomputed if it or one of its neighbors changed in the last generation
+    static constexpr uint16_t TileSize{ 32 };
+
+    [[nodiscard]] uint32_t GetTileCount() const noexcept
+    {
+        return _tilesAcross * _tilesDown;
+    }
+
+    // how many tiles were recomputed in the last generation
+    [[nodiscard]] uint32_t GetActiveTileCount() const noexcept
+    {
+        return _activeTiles;
+    }
+
 private:
+    // the microbenchmarks time the per-cell functions below
+    friend struct BoardBenchAccess;
+
     // board updating
-    // Update calls UpdateRowsWithNextState and FastDetermineNextState
-    // if you drew the board in between those calls, you'd see the intermediate states e.g. cells born or that will die
-    // in the next generation many of these are split up to support multithreading
-    void SetCell(Cell& cell, Cell::State state) noexcept;
-    void UpdateRowsWithNextState(uint16_t startRow, uint16_t endRow, BoardRules rules);
-    void FastDetermineNextState(BoardRules rules);
+    // Update calls FastDetermineNextState, which calls UpdateRowsWithNextState on each thread
+    // the current generation in _states is only read, the next generation is written into _nextstates
+    // and the two are swapped once every row is done, so readers always see a whole generation
+    // many of these are split up to support multithreading
+    // the functions that run on a range of rows add up its counts, and XOR up the hash keys of the cells that changed
+    // when the hash is tracked, and ReducePartialCounts folds them into the board's
+    void SetCell(size_t index, Cell::State state) noexcept;
+    void NextState(const Rule& rule);
+    void UpdateRowsWithNextState(uint16_t startRow, uint16_t endRow, const Rule& rule, GenerationCounts& counts, uint64_t& hash);
+    void FastDetermineNextState(const Rule& rule);
+    void FillAliveRows(uint16_t startRow, uint16_t endRow) noexcept;
+    void FindActiveTiles() noexcept;
     void CountLiveAndDyingNeighbors(uint16_t x, uint16_t y);
     [[nodiscard]] uint8_t CountLiveNotDyingNeighbors(uint16_t x, uint16_t y);
-    void ApplyNextState() noexcept;
+    void ReducePartialCounts() noexcept;
+    void RandomizeRows(uint16_t startRow, uint16_t endRow, uint32_t probability, Xoshiro256& random, GenerationCounts& counts, uint64_t& hash) noexcept;
+    void RecordPhaseTimes(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stepStart, std::chrono::steady_clock::time_point stepEnd, uint32_t generations = 1) noexcept;
+
+    // temporal blocking, for B/S rules: a BlockSize x BlockSize block of the alive bytes is copied with a border
+    // as wide as the generations to run into a scratch buffer that stays in cache, the scratch is stepped that many times
+    // while the part that's still right shrinks by a cell a side each time, and what's left is exactly the block
+    // each thread has its own scratch
+    struct BlockScratch
+    {
+        std::vector<uint8_t> current;
+        std::vector<uint8_t> next;
+        std::vector<uint8_t> counts;
+        std::vector<uint8_t> bornAt;
+    };
+
+    static constexpr uint16_t BlockSize{ 128 };
+
+    void BlockedNextState(const Rule& rule, uint16_t generations);
+    void StepBlock(uint16_t bx, uint16_t by, const Rule& rule, uint16_t generations, BlockScratch& scratch, GenerationCounts& counts, uint64_t& hash);
+    [[nodiscard]] bool BlockSource(int& x, int& y) const noexcept;
+
+    // FastConway runs on the bit-packed board, 64 cells per word
+    // the states are kept in sync so GetCell, Alive and the renderer see the same board
+    void BitwiseConwayNextState();
+    void LoadBitBoard();
+    void ApplyBitRows(uint16_t startRow, uint16_t endRow, GenerationCounts& counts, uint64_t& hash);
+
+    // Generations rules run on bit planes the same way, and the Cells are kept in sync the same way
+    void GenerationsNextState(const Rule& rule);
+    void LoadPlanes(uint16_t states);
+    void ApplyPlaneRows(uint16_t startRow, uint16_t endRow, GenerationCounts& counts, uint64_t& hash);
+
+    // incremental B/S generations: the neighbor plane holds the counts of the current generation,
+    // each birth or death adds or takes one from its 8 neighbors, and only the cells it touched are candidates next time
+    // the changes are found on every thread and applied in place on one
+    void IncrementalNextState(const Rule& rule);
+    void LoadNeighbors();
+    void FindChanges(size_t first, size_t last, const Rule& rule, std::vector<uint32_t>& changes) const;
+    void FindChangesRows(uint16_t startRow, uint16_t endRow, const Rule& rule, std::vector<uint32_t>& changes) const;
+    void ApplyChange(uint32_t padded) noexcept;
+    void AddDeltas(uint32_t padded, uint8_t delta) noexcept;
+
+    void AddCandidate(uint32_t padded) noexcept
+    {
+        if (!_candidate[padded])
+        {
+            _candidate[padded] = 1;
+            _nextCandidates.push_back(padded);
+        }
+    }
 
-    // rulesets
-    void ConwayRules(Cell& cell) const noexcept;
-    void FastConwayRules(Cell& cell) const noexcept;
-    void DayAndNightRules(Cell& cell) const noexcept;
-    void LifeWithoutDeathRules(Cell& cell) const noexcept;
-    void HighlifeRules(Cell& cell) const noexcept;
-    void SeedsRules(Cell& cell) const noexcept;
-    void BriansBrainRules(Cell& cell) const noexcept;
+    // one generation the way Update(BoardRules) runs it
+    void Step(const Rule& rule, bool fastConway);
+    // both Update(rule, generations), with _lockboard held
+    void StepGenerations(const Rule& rule, uint32_t generations, bool fastConway);
+
+    // cycle detection, TrackCycle runs after every generation and ReplayCycle before it
+    // once a hash repeats, the generations up to the next repeat are recorded as they're computed
+    // a replayed generation applies the changes recorded for its phase of the cycle, nothing is counted
+    struct CycleChange
+    {
+        uint32_t index;
+        Cell::State state;
+        bool born;
+    };
+
+    struct CyclePhase
+    {
+        std::vector<CycleChange> changes;
+        GenerationCounts counts;
+    };
+
+    struct CycleEntry
+    {
+        uint32_t generation;
+        uint64_t hash;
+    };
+
+    void TrackCycle(const Rule& rule);
+    void RecordCycle(uint64_t hash);
+    [[nodiscard]] bool ReplayCycle(const Rule& rule);
+
+    // one remembered generation, a keyframe holds the whole board and any other frame the cells that changed
+    // since the frame before it, with their state and birth generation, which also brings back a decaying cell's stage
+    struct RewindChange
+    {
+        uint32_t index;
+        uint16_t birth;
+        Cell::State state;
+    };
+
+    struct RewindFrame
+    {
+        uint32_t generation{ 0 };
+        GenerationCounts counts;
+        bool keyframe{ false };
+        std::vector<Cell::State> states;
+        std::vector<uint16_t> births;
+        std::vector<RewindChange> changes;
+
+        [[nodiscard]] size_t Bytes() const noexcept
+        {
+            return sizeof(RewindFrame) + (states.size() * sizeof(Cell::State)) + (births.size() * sizeof(uint16_t)) + (changes.size() * sizeof(RewindChange));
+        }
+    };
+
+    void Remember();
+    void RememberKeyframe();
+    void FindRewindChanges(uint16_t startRow, uint16_t endRow, std::vector<RewindChange>& changes);
+    void TrimRewind() noexcept;
+    void ForgetRewind() noexcept;
+    bool Seek(uint32_t generation);
+
+    void ForgetCycle() noexcept
+    {
+        _cycle = {};
+        _cycleHistory.clear();
+        _cyclePhases.clear();
+        _cyclePhase = 0;
+        _cycleRecording = 0;
+        _cycleHashes.clear();
+        _cycleStart.clear();
+        _cycleBefore.clear();
+        _cycleBirths.clear();
+    }
+
+    // the bits, the planes, the alive bytes, the tile activity and the cycle history are derived from _states
+    // anything that edits _states directly calls this
+    void InvalidateDerived() noexcept
+    {
+        _bitsInSync = false;
+        _planesInSync = false;
+        _aliveInSync = false;
+        _tilesInSync = false;
+        _neighborsInSync = false;
+        ForgetCycle();
+    }
+
+    // the byte planes (alive, next alive, neighbor counts) have a halo, one cell all around the board,
+    // so the cell at (x, y) is at (x + 1, y + 1) of a row _stride bytes long
+    // the halo is filled from the board once a generation, from the links the topology makes,
+    // and the count reads past the edges without wrapping
+    [[nodiscard]] size_t PaddedIndex(uint16_t x, uint16_t y) const noexcept
+    {
+        return (gsl::narrow_cast<size_t>(y) + 1) * _stride + x + 1;
+    }
+
+    [[nodiscard]] size_t StateIndex(size_t padded) const noexcept
+    {
+        return ((padded / _stride) - 1) * _width + (padded % _stride) - 1;
+    }
+
+    void BuildHalo();
+    void FillHalo() noexcept;
+
+    [[nodiscard]] Cell::State StateAt(uint16_t x, uint16_t y) const noexcept
+    {
+        return _states[x + (y * _width)];
+    }
+
+    // a cell's age is how many generations ago it was born, kept as 16 bits so it wraps like a uint16_t counter would
+    // decaying cells draw in the oldest color, their births count the decay instead
+    [[nodiscard]] uint16_t CellAge(size_t index) const noexcept
+    {
+        if (_states[index] == Cell::State::Decaying)
+        {
+            return _maxage + 1;
+        }
+        return gsl::narrow_cast<uint16_t>(gsl::narrow_cast<uint16_t>(_generation) - _births[index]);
+    }
+
+    void CellAge(size_t index, uint16_t age) noexcept
+    {
+        _births[index] = gsl::narrow_cast<uint16_t>(gsl::narrow_cast<uint16_t>(_generation) - age);
+    }
 
     void ResetCounts() noexcept
     {
-        _numDead = 0;
-        _numLive = 0;
-        _numBorn = 0;
-        _numDying = 0;
-        _numOld = 0;
+        _counts = {};
         //_generation = 0;
     }
 
+    // RandomizeBoard gives every band of this many rows its own random stream
+    static constexpr uint16_t RandomBandRows{ 16 };
+
   private:
 	  int _threadcount{1};
       uint16_t _maxage{ 100 };
       std::mutex _lockboard;
-	  std::vector<Cell> _cells;
+	  // front (current generation) and back (next generation) buffers
+	  std::vector<Cell::State> _states;
+	  std::vector<Cell::State> _nextstates;
+	  // the last neighbor count of each cell, the current one while incremental generations run, padded like _alive
+	  std::vector<uint8_t> _neighbors;
+	  // the generation each cell's age counts from, only written when a cell is born or edited,
+	  // so cells that just get older cost nothing; for a Decaying cell it's the generation it started decaying,
+	  // which gives its decay stage when the planes are loaded
+	  std::vector<uint16_t> _births;
+	  BitBoard _bits;
+	  GenerationsBitBoard _planes;
+	  NeighborKernel _kernel;
+	  ThreadPool _pool;
+	  // one byte per cell, 1 if the cell is alive, also front and back, with the halo
+	  std::vector<uint8_t> _alive;
+	  std::vector<uint8_t> _nextalive;
+	  bool _aliveInSync{ false };
+	  // a halo cell and the padded index of the cell it copies, sorted by the cell
+	  // a halo cell without a link stays dead
+	  struct HaloLink
+	  {
+	      uint32_t halo;
+	      uint32_t source;
+	  };
+	  std::vector<HaloLink> _halo;
+	  Topology _topology{ Topology::Torus };
+	  uint32_t _stride{ 2 };
+	  uint16_t _blockGenerations{ 8 };
+	  // cycle detection: the hashes of the last generations, the cycle once it's confirmed,
+	  // what changes in each generation of it and the phase the board is in
+	  CycleAction _cycleAction{ CycleAction::Off };
+	  Rule _cycleRule;
+	  std::vector<CycleEntry> _cycleHistory;
+	  CycleInfo _cycle;
+	  std::vector<CyclePhase> _cyclePhases;
+	  uint32_t _cyclePhase{ 0 };
+	  // while a cycle is recorded: the generations left, their hashes, the board it started from and the one before
+	  uint32_t _cycleRecording{ 0 };
+	  std::vector<uint64_t> _cycleHashes;
+	  std::vector<Cell::State> _cycleStart;
+	  std::vector<Cell::State> _cycleBefore;
+	  std::vector<uint16_t> _cycleBirths;
+	  std::vector<BlockScratch> _blockScratch;
+	  // the Zobrist hash, whether it's kept up to date and whether it is, and each thread's share of a generation's changes
+	  uint64_t _hash{ 0 };
+	  bool _hashTracking{ false };
+	  bool _hashInSync{ false };
+	  std::vector<uint64_t> _partialHashes;
+	  // one byte per tile: did it change in the last generation, and does it need computing in this one
+	  std::vector<uint8_t> _tileChanged;
+	  std::vector<uint8_t> _tileActive;
+	  uint16_t _tilesAcross{ 0 };
+	  uint16_t _tilesDown{ 0 };
+	  uint32_t _activeTiles{ 0 };
+	  bool _tilesInSync{ false };
+	  Rule _tileRule;
+	  bool _bitsInSync{ false };
+	  bool _planesInSync{ false };
+	  // incremental neighbor counts: whether _neighbors holds the current counts, the live cells, the rule the candidates were found with,
+	  // the padded index of each cell to look at this generation (every cell when _allCandidates),
+	  // and one byte per padded cell so none is listed twice, always set for the halo so it's never listed
+	  bool _incremental{ false };
+	  bool _neighborsInSync{ false };
+	  bool _allCandidates{ true };
+	  uint32_t _liveCells{ 0 };
+	  Rule _incrementalRule;
+	  std::vector<uint32_t> _candidates;
+	  std::vector<uint32_t> _nextCandidates;
+	  std::vector<uint8_t> _candidate;
+	  std::vector<std::vector<uint32_t>> _partialChanges;
+	  // rewinding: the remembered generations oldest first, the board as of the newest one to compare the next one with,
+	  // each thread's share of the changes, the cap, the bytes used and how often a keyframe is kept
+	  std::deque<RewindFrame> _rewindFrames;
+	  std::vector<Cell::State> _rewindStates;
+	  std::vector<uint16_t> _rewindBirths;
+	  std::vector<std::vector<RewindChange>> _partialRewind;
+	  size_t _rewindCap{ 0 };
+	  size_t _rewindBytes{ 0 };
+	  uint32_t _rewindKeyframes{ 64 };
 
 	  uint16_t _width{ 0 };
 	  uint16_t _height{ 0 };
 
 	  uint32_t _generation{ 0 };
-	  uint32_t _numDead{ 0 };
-	  uint32_t _numLive{ 0 };
-	  uint32_t _numBorn{ 0 };
-	  uint32_t _numOld{ 0 };
-	  uint32_t _numDying{ 0 };
+	  GenerationCounts _counts;
+	  PhaseTimes _phaseTimes;
+	  std::vector<GenerationCounts> _partialCounts;
 	  uint32_t _OldAge{ 0xFFFFFFFF };
 };
@@ -18,6 +18,8 @@ const char* Cell::GetStateString() const noexcept
 			break;
 		case Cell::State::Dying: return ".";
 			break;
+		case Cell::State::Decaying: return ",";
+			break;
 		default:
 			return "?";
 	}
@@ -44,6 +46,8 @@ const std::wstring& Cell::GetEmojiStateString() const
 			break;
 		case Cell::State::Dying: return sDying;
 			break;
+		case Cell::State::Decaying: return sDying;
+			break;
 		default:
 			return sUnknown;
 	}
@@ -7,7 +7,8 @@
 class Cell
 {
 public:
-    enum class State : uint8_t { Dead, Born, Live, Old, Dying, BrianDying };
+    // Decaying is a Generations cell on its way from Live to Dead, it's drawn but not counted as a neighbor
+    enum class State : uint8_t { Dead, Born, Live, Old, Dying, Decaying };
 
 private:
     State _state{ State::Dead };
@@ -16,16 +17,17 @@ private:
 
 public:
     Cell() = default;
+    Cell(State state, uint8_t neighbors, uint16_t age) noexcept : _state(state), _neighbors(neighbors), _age(age) {}
     ~Cell() = default;
 
     // move/copy constuct
     Cell(Cell&& b) = default;
-    Cell(Cell& b) = default;
+    Cell(const Cell& b) = default;
 
-    // no need to assign one cell to another cell
+    // each cell in the next generation starts as a copy of the cell in the current generation
     // TODO future, compare by age or Live/Dead
-    Cell& operator=(Cell&& b) = delete;
-    Cell& operator=(Cell& b) = delete;
+    Cell& operator=(Cell&& b) = default;
+    Cell& operator=(const Cell& b) = default;
 
     [[nodiscard]] uint8_t Neighbors() const noexcept
     {
@@ -74,7 +76,7 @@ public:
 
     [[nodiscard]] bool ShouldDraw() const noexcept
     {
-        if (_state == State::Live || _state == State::BrianDying)
+        if (_state == State::Live || _state == State::Decaying)
         {
             return true;
         }
@@ -83,16 +85,27 @@ public:
     
     [[nodiscard]] bool IsAlive() const noexcept
     {
-        if (_state == State::Live || _state == State::Dying || _state == State::Old)
+        return IsAlive(_state);
+    }
+
+    [[nodiscard]] bool IsAliveNotDying() const noexcept
+    {
+        return IsAliveNotDying(_state);
+    }
+
+    // the same tests for a bare state, Board keeps its states without the rest of the Cell
+    [[nodiscard]] static bool IsAlive(State state) noexcept
+    {
+        if (state == State::Live || state == State::Dying || state == State::Old)
         {
             return true;
         }
         return false;
     }
 
-    [[nodiscard]] bool IsAliveNotDying() const noexcept
+    [[nodiscard]] static bool IsAliveNotDying(State state) noexcept
     {
-        if (_state == State::Live)
+        if (state == State::Live)
         {
             return true;
         }
@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include "FrameGovernor.h"
+
+#include <algorithm>
+
+void FrameGovernor::DetailLevels(uint8_t levels) noexcept
+{
+	_levels = std::clamp(levels, uint8_t{ 1 }, MaxDetailLevels);
+	_detail = std::min(_detail, static_cast<uint8_t>(_levels - 1));
+}
+
+void FrameGovernor::MaxGenerationsPerFrame(uint32_t generations) noexcept
+{
+	_maxGenerations = std::max(generations, 1u);
+	_generations = std::min(_generations, _maxGenerations);
+}
+
+void FrameGovernor::Reset() noexcept
+{
+	_detail = 0;
+	_generations = _maxGenerations;
+	_fresh = true;
+	_settling = 0;
+	_steppedDownFrom = 0.0;
+}
+
+bool FrameGovernor::AddFrame(const FrameTimes& times) noexcept
+{
+	using std::chrono::nanoseconds;
+
+	const nanoseconds perGeneration = times.update / std::max(times.generations, 1u);
+	if (_fresh)
+	{
+		_average = times;
+		_average.update = perGeneration;
+		_average.generations = 1;
+		_fresh = false;
+	}
+	else
+	{
+		const auto blend = [](nanoseconds average, nanoseconds sample) noexcept
+			{
+				return nanoseconds{ static_cast<int64_t>(static_cast<double>(average.count()) + (static_cast<double>((sample - average).count()) * Smoothing)) };
+			};
+		_average.update = blend(_average.update, perGeneration);
+		_average.render = blend(_average.render, times.render);
+		_average.composite = blend(_average.composite, times.composite);
+	}
+
+	if (_settling > 0)
+	{
+		_settling--;
+		return false;
+	}
+
+	const double draw = static_cast<double>(std::max((_average.render + _average.composite).count(), int64_t{ 1 }));
+	const double generation = static_cast<double>(std::max(_average.update.count(), int64_t{ 1 }));
+
+	// settled after stepping down, so this is what the level costs next to the one above it
+	if (_steppedDownFrom > 0.0)
+	{
+		_costRatio[_detail - 1] = std::max(_steppedDownFrom / draw, 1.0);
+		_steppedDownFrom = 0.0;
+	}
+
+	// drawing alone doesn't fit, draw less
+	if (draw > Budget(High) && _detail + 1 < _levels)
+	{
+		_detail++;
+		_fresh = true;
+		_settling = SettleFrames;
+		_steppedDownFrom = draw;
+		return true;
+	}
+
+	// the generations get whatever drawing leaves, they drop at once and grow by doubling
+	const double room = std::max(Budget(High) - draw, 0.0);
+	const auto fit = static_cast<uint32_t>(std::clamp(room / generation, 1.0, static_cast<double>(_maxGenerations)));
+	uint32_t generations = _generations;
+	if (fit < _generations)
+	{
+		generations = fit;
+	}
+	else if (fit > _generations && draw + (generation * _generations) < Budget(Low))
+	{
+		generations = std::min(fit, _generations * 2);
+	}
+
+	// everything fits with room to spare, try more detail once the estimate for it fits too
+	if (generations == _maxGenerations && _detail > 0 && draw * _costRatio[_detail - 1] + (generation * generations) < Budget(Low))
+	{
+		_detail--;
+		_fresh = true;
+		_settling = SettleFrames;
+		return true;
+	}
+
+	if (generations != _generations)
+	{
+		_generations = generations;
+		_settling = SettleFrames;
+		return true;
+	}
+	return false;
+}
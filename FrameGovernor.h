@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// what one frame cost, by phase
+// update is the time to compute the generations the frame shows, render draws the board offscreen,
+// composite copies the offscreen slices to the canvas
+struct FrameTimes
+{
+    std::chrono::nanoseconds update{ 0 };
+    uint32_t generations{ 1 };
+    std::chrono::nanoseconds render{ 0 };
+    std::chrono::nanoseconds composite{ 0 };
+};
+
+// keeps frames inside a time budget by trading away generations per frame and render detail
+// detail 0 is the most detailed, higher levels are cheaper to draw; drawing is cut first, since a frame
+// that can't be drawn in time stutters however few generations it shows, then the generations fill what's left
+// every change waits a few frames for the averages to settle, and detail only comes back once the estimate
+// for the next level up fits with room to spare, so it doesn't flip back and forth at the edge of the budget
+class FrameGovernor
+{
+public:
+    FrameGovernor() = default;
+
+    void Target(std::chrono::nanoseconds target) noexcept
+    {
+        _target = target;
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds Target() const noexcept
+    {
+        return _target;
+    }
+
+    // how many levels of detail the renderer has, at most MaxDetailLevels
+    void DetailLevels(uint8_t levels) noexcept;
+
+    [[nodiscard]] uint8_t DetailLevels() const noexcept
+    {
+        return _levels;
+    }
+
+    // the generations per frame the speed setting asks for, the governor never goes over it
+    void MaxGenerationsPerFrame(uint32_t generations) noexcept;
+
+    [[nodiscard]] uint32_t MaxGenerationsPerFrame() const noexcept
+    {
+        return _maxGenerations;
+    }
+
+    // adds a frame's times, true if the generations per frame or the detail changed
+    bool AddFrame(const FrameTimes& times) noexcept;
+
+    // what the governor chose
+    [[nodiscard]] uint32_t GenerationsPerFrame() const noexcept
+    {
+        return _generations;
+    }
+
+    [[nodiscard]] uint8_t Detail() const noexcept
+    {
+        return _detail;
+    }
+
+    // the averaged times the choices are made from, update is per generation
+    [[nodiscard]] const FrameTimes& Average() const noexcept
+    {
+        return _average;
+    }
+
+    // starts over at full detail and the most generations, e.g. after the board is resized
+    void Reset() noexcept;
+
+    static constexpr uint8_t MaxDetailLevels{ 4 };
+
+    // a frame is over budget past High of the target, and there's room to spare under Low
+    static constexpr double High{ 0.9 };
+    static constexpr double Low{ 0.6 };
+
+    // frames to wait after a change before making another one
+    static constexpr uint32_t SettleFrames{ 8 };
+
+private:
+    [[nodiscard]] double Budget(double fraction) const noexcept
+    {
+        return static_cast<double>(_target.count()) * fraction;
+    }
+
+    // each new frame counts for an eighth of the average
+    static constexpr double Smoothing{ 0.125 };
+
+    std::chrono::nanoseconds _target{ std::chrono::milliseconds{ 16 } };
+    uint8_t _levels{ 1 };
+    uint8_t _detail{ 0 };
+    uint32_t _maxGenerations{ 1 };
+    uint32_t _generations{ 1 };
+
+    FrameTimes _average;
+    // the next frame replaces the averages instead of being added to them, after a start or a change of detail
+    bool _fresh{ true };
+    uint32_t _settling{ 0 };
+
+    // how much more a level costs to draw than the level after it, measured when the governor stepped down
+    std::array<double, MaxDetailLevels> _costRatio{ 2.0, 2.0, 2.0, 2.0 };
+    double _steppedDownFrom{ 0.0 };
+};
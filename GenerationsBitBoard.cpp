@@ -0,0 +1,118 @@
+#include "pch.h"
+
+#include "GenerationsBitBoard.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include <gsl/gsl>
+
+void GenerationsBitBoard::Resize(uint16_t width, uint16_t height, uint16_t states)
+{
+	_alive.Resize(width, height);
+
+	_states = states;
+	_planeCount = gsl::narrow_cast<uint16_t>(std::bit_width(gsl::narrow_cast<unsigned int>(states - 1)));
+	_rowWords = gsl::narrow_cast<size_t>(_planeCount) * _alive.WordsPerRow();
+
+	const size_t newsize = _rowWords * height;
+	_planes.assign(newsize, 0);
+	_nextPlanes.assign(newsize, 0);
+}
+
+void GenerationsBitBoard::Clear() noexcept
+{
+	_alive.Clear();
+	std::fill(_planes.begin(), _planes.end(), 0);
+}
+
+uint8_t GenerationsBitBoard::Get(uint16_t x, uint16_t y) const noexcept
+{
+	uint8_t state = 0;
+	for (uint16_t p = 0; p < _planeCount; p++)
+	{
+		state |= gsl::narrow_cast<uint8_t>(((_planes[WordIndex(x, y, p)] >> (x & 63)) & 1) << p);
+	}
+	return state;
+}
+
+void GenerationsBitBoard::Set(uint16_t x, uint16_t y, uint8_t state) noexcept
+{
+	const uint64_t bit = uint64_t{ 1 } << (x & 63);
+	for (uint16_t p = 0; p < _planeCount; p++)
+	{
+		uint64_t& word = _planes[WordIndex(x, y, p)];
+		word = ((state >> p) & 1) ? (word | bit) : (word & ~bit);
+	}
+	_alive.Set(x, y, state == 1);
+}
+
+void GenerationsBitBoard::StepRows(uint16_t startRow, uint16_t endRow, const Rule& rule) noexcept
+{
+	const uint16_t wordsPerRow = _alive.WordsPerRow();
+	const uint16_t height = _alive.Height();
+
+	// if the state count is a power of two, counting up from the last state wraps to 0 by itself
+	const bool wraps = std::has_single_bit(_states);
+
+	for (uint16_t y = startRow; y < endRow; y++)
+	{
+		const uint16_t yabove = (y == 0) ? height - 1 : y - 1;
+		const uint16_t ybelow = (y == height - 1) ? 0 : y + 1;
+
+		const uint64_t* above = _alive.Row(yabove);
+		const uint64_t* alive = _alive.Row(y);
+		const uint64_t* below = _alive.Row(ybelow);
+		uint64_t* nextAlive = _alive.NextRow(y);
+
+		const uint64_t* planes = Row(y);
+		uint64_t* next = _nextPlanes.data() + (y * _rowWords);
+
+		for (uint16_t k = 0; k < wordsPerRow; k++)
+		{
+			const BitBoard::NeighborCounts count = _alive.CountNeighbors(above, alive, below, k);
+
+			// add one to every cell's state, one plane at a time
+			std::array<uint64_t, 8> plus{};
+			uint64_t carry = ~uint64_t{ 0 };
+			uint64_t occupied = 0;
+			for (uint16_t p = 0; p < _planeCount; p++)
+			{
+				const uint64_t bits = planes[p * wordsPerRow + k];
+				occupied |= bits;
+				plus[p] = bits ^ carry;
+				carry &= bits;
+			}
+
+			// cells where state + 1 is the state count go back to 0
+			uint64_t last = 0;
+			if (!wraps)
+			{
+				last = ~uint64_t{ 0 };
+				for (uint16_t p = 0; p < _planeCount; p++)
+				{
+					last &= ((_states >> p) & 1) ? plus[p] : ~plus[p];
+				}
+			}
+
+			// dead cells can be born, live cells can survive, every other cell that isn't dead moves on to its next state
+			const uint64_t born = ~occupied & count.Matching(rule.Birth());
+			const uint64_t survived = alive[k] & count.Matching(rule.Survival());
+			const uint64_t decaying = occupied & ~survived & ~last;
+
+			uint64_t nowAlive = born | survived;
+			if (k == wordsPerRow - 1)
+			{
+				nowAlive &= _alive.LastMask();
+			}
+
+			next[k] = (plus[0] & decaying) | nowAlive;
+			for (uint16_t p = 1; p < _planeCount; p++)
+			{
+				next[p * wordsPerRow + k] = plus[p] & decaying;
+			}
+			nextAlive[k] = nowAlive;
+		}
+	}
+}
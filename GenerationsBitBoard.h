@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BitBoard.h"
+#include "Rule.h"
+
+// GenerationsBitBoard holds a Generations board (0 dead, 1 alive, 2 and up decaying) as bit planes,
+// plane p has bit p of every cell's state packed 64 cells to a word, laid out like BitBoard
+// the planes for row y are next to each other, so a step reads one block of memory per row
+// the live cells are also kept in a BitBoard, which counts their neighbors
+class GenerationsBitBoard
+{
+public:
+    GenerationsBitBoard() = default;
+    ~GenerationsBitBoard() = default;
+
+    // move/copy constuct
+    GenerationsBitBoard(GenerationsBitBoard&& b) = delete;
+    GenerationsBitBoard(GenerationsBitBoard& b) = delete;
+
+    // no need to assign one bitboard to another bitboard
+    GenerationsBitBoard& operator=(GenerationsBitBoard&& b) = delete;
+    GenerationsBitBoard& operator=(GenerationsBitBoard& b) = delete;
+
+    // states decides the number of planes, 3 needs 2 planes and 256 needs 8
+    void Resize(uint16_t width, uint16_t height, uint16_t states);
+    void Clear() noexcept;
+
+    [[nodiscard]] uint8_t Get(uint16_t x, uint16_t y) const noexcept;
+    void Set(uint16_t x, uint16_t y, uint8_t state) noexcept;
+
+    // computes the next generation for rows [startRow, endRow) into the back buffer
+    // rule.States() has to match the states the board was sized for
+    // only reads the current generation, so disjoint row ranges can run on different threads
+    void StepRows(uint16_t startRow, uint16_t endRow, const Rule& rule) noexcept;
+
+    // makes the back buffer the current generation
+    void Swap() noexcept
+    {
+        _alive.Swap();
+        _planes.swap(_nextPlanes);
+    }
+
+    // the planes of row y, plane p starts at p * WordsPerRow()
+    [[nodiscard]] const uint64_t* Row(uint16_t y) const noexcept
+    {
+        return _planes.data() + (y * _rowWords);
+    }
+
+    [[nodiscard]] const uint64_t* NextRow(uint16_t y) const noexcept
+    {
+        return _nextPlanes.data() + (y * _rowWords);
+    }
+
+    // one bit per cell, set for state 1
+    [[nodiscard]] const uint64_t* AliveRow(uint16_t y) const noexcept
+    {
+        return _alive.Row(y);
+    }
+
+    [[nodiscard]] const uint64_t* NextAliveRow(uint16_t y) const noexcept
+    {
+        return _alive.NextRow(y);
+    }
+
+    [[nodiscard]] uint16_t WordsPerRow() const noexcept
+    {
+        return _alive.WordsPerRow();
+    }
+
+    [[nodiscard]] uint16_t PlaneCount() const noexcept
+    {
+        return _planeCount;
+    }
+
+    [[nodiscard]] uint16_t States() const noexcept
+    {
+        return _states;
+    }
+
+private:
+    [[nodiscard]] size_t WordIndex(uint16_t x, uint16_t y, uint16_t plane) const noexcept
+    {
+        return (y * _rowWords) + (plane * _alive.WordsPerRow()) + (x >> 6);
+    }
+
+private:
+    BitBoard _alive;
+    std::vector<uint64_t> _planes;
+    std::vector<uint64_t> _nextPlanes;
+
+    uint16_t _states{ 0 };
+    uint16_t _planeCount{ 0 };
+    // words in all the planes of one row
+    size_t _rowWords{ 0 };
+};
@@ -0,0 +1,647 @@
+#include "pch.h"
+
+#include <array>
+
+#include "HashLife.h"
+#include "Board.h"
+#include "Log.h"
+#include "Macrocell.h"
+#include "MappedFile.h"
+#include "Rule.h"
+
+HashLife::HashLife(uint16_t birth, uint16_t survival)
+	: _birth(gsl::narrow_cast<uint16_t>(birth & ~1u)), _survival(survival)
+{
+	Clear();
+}
+
+void HashLife::Clear()
+{
+	_nodes.clear();
+	_index.clear();
+	_empty.clear();
+
+	// the two single cells are always nodes 0 and 1
+	_nodes.push_back(Node{ .population = 0, .level = 0 });
+	_nodes.push_back(Node{ .population = 1, .level = 0 });
+
+	_root = Empty(3);
+	_generation = 0;
+	_stepLog2 = 0;
+}
+
+HashLife::NodeId HashLife::Join(NodeId nw, NodeId ne, NodeId sw, NodeId se)
+{
+	const NodeKey key{ nw, ne, sw, se };
+	if (const auto found = _index.find(key); found != _index.end())
+	{
+		return found->second;
+	}
+
+	Node node{ .nw = nw, .ne = ne, .sw = sw, .se = se };
+	node.population = _nodes[nw].population + _nodes[ne].population + _nodes[sw].population + _nodes[se].population;
+	node.level = _nodes[nw].level + 1;
+
+	const auto id = gsl::narrow_cast<NodeId>(_nodes.size());
+	_nodes.push_back(node);
+	_index.emplace(key, id);
+	return id;
+}
+
+HashLife::NodeId HashLife::Empty(uint8_t level)
+{
+	if (_empty.empty())
+	{
+		_empty.push_back(Dead);
+	}
+
+	while (_empty.size() <= level)
+	{
+		const NodeId e = _empty.back();
+		_empty.push_back(Join(e, e, e, e));
+	}
+	return _empty[level];
+}
+
+// the same cells in a node one level up, so there is empty space all around them
+HashLife::NodeId HashLife::Expand(NodeId node)
+{
+	const Node n = _nodes[node];
+	const NodeId e = Empty(n.level - 1);
+	return Join(Join(e, e, e, n.nw), Join(e, e, n.ne, e), Join(e, n.sw, e, e), Join(n.se, e, e, e));
+}
+
+// the center half of a node, one level down
+HashLife::NodeId HashLife::Centre(NodeId node)
+{
+	const Node n = _nodes[node];
+	return Join(_nodes[n.nw].se, _nodes[n.ne].sw, _nodes[n.sw].ne, _nodes[n.se].nw);
+}
+
+// a 4x4 node advanced one generation is its center 2x2
+HashLife::NodeId HashLife::StepLevel2(NodeId node)
+{
+	const Node n = _nodes[node];
+
+	std::array<std::array<uint8_t, 4>, 4> cells{};
+	const auto fill = [&](NodeId quad, int x, int y)
+	{
+		const Node& q = _nodes[quad];
+		cells[y][x] = (q.nw == Alive);
+		cells[y][x + 1] = (q.ne == Alive);
+		cells[y + 1][x] = (q.sw == Alive);
+		cells[y + 1][x + 1] = (q.se == Alive);
+	};
+	fill(n.nw, 0, 0);
+	fill(n.ne, 2, 0);
+	fill(n.sw, 0, 2);
+	fill(n.se, 2, 2);
+
+	const auto next = [&](int x, int y) -> NodeId
+	{
+		int neighbors = 0;
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				neighbors += cells[y + dy][x + dx];
+			}
+		}
+		neighbors -= cells[y][x];
+
+		const uint16_t rule = cells[y][x] ? _survival : _birth;
+		return ((rule >> neighbors) & 1) ? Alive : Dead;
+	};
+
+	return Join(next(1, 1), next(2, 1), next(1, 2), next(2, 2));
+}
+
+// the center half of a node advanced 2^stepLog2 generations, stepLog2 is at most level - 2
+// a full step (stepLog2 == level - 2) advances the nine overlapping sub-squares a quarter of the way,
+// then the four squares made from them another quarter; a partial step only advances the nine
+HashLife::NodeId HashLife::Successor(NodeId node, uint8_t stepLog2)
+{
+	const Node n = _nodes[node];
+	const bool full = (stepLog2 == n.level - 2);
+
+	if (n.population == 0)
+	{
+		return Empty(n.level - 1);
+	}
+
+	if (full && n.full != None)
+	{
+		return n.full;
+	}
+
+	if (!full && n.partial != None)
+	{
+		return n.partial;
+	}
+
+	NodeId result{ None };
+	if (n.level == 2)
+	{
+		result = StepLevel2(node);
+	}
+	else
+	{
+		const Node nw = _nodes[n.nw];
+		const Node ne = _nodes[n.ne];
+		const Node sw = _nodes[n.sw];
+		const Node se = _nodes[n.se];
+
+		// nine overlapping squares, each half the size of node
+		const std::array<NodeId, 9> squares{
+			n.nw, Join(nw.ne, ne.nw, nw.se, ne.sw), n.ne,
+			Join(nw.sw, nw.se, sw.nw, sw.ne), Join(nw.se, ne.sw, sw.ne, se.nw), Join(ne.sw, ne.se, se.nw, se.ne),
+			n.sw, Join(sw.ne, se.nw, sw.se, se.sw), n.se
+		};
+
+		const uint8_t childStep = full ? gsl::narrow_cast<uint8_t>(n.level - 3) : stepLog2;
+		std::array<NodeId, 9> c{};
+		for (size_t i = 0; i < squares.size(); i++)
+		{
+			c[i] = Successor(squares[i], childStep);
+		}
+
+		const NodeId q0 = Join(c[0], c[1], c[3], c[4]);
+		const NodeId q1 = Join(c[1], c[2], c[4], c[5]);
+		const NodeId q2 = Join(c[3], c[4], c[6], c[7]);
+		const NodeId q3 = Join(c[4], c[5], c[7], c[8]);
+
+		if (full)
+		{
+			result = Join(Successor(q0, childStep), Successor(q1, childStep), Successor(q2, childStep), Successor(q3, childStep));
+		}
+		else
+		{
+			result = Join(Centre(q0), Centre(q1), Centre(q2), Centre(q3));
+		}
+	}
+
+	// _nodes may have grown since n was copied
+	if (full)
+	{
+		_nodes[node].full = result;
+	}
+	else
+	{
+		_nodes[node].partial = result;
+	}
+	return result;
+}
+
+void HashLife::ForgetPartialResults() noexcept
+{
+	for (auto& node : _nodes)
+	{
+		node.partial = None;
+	}
+}
+
+void HashLife::Step(uint8_t stepLog2)
+{
+	// partial results are only good for one step size
+	if (stepLog2 != _stepLog2)
+	{
+		ForgetPartialResults();
+		_stepLog2 = stepLog2;
+	}
+
+	if (MemoryUsage() > _memoryBudget)
+	{
+		CollectGarbage();
+	}
+
+	// the cells have to fit in the center half of the root and the root has to be big enough for the step,
+	// then one more level leaves room for the cells to spread 2^stepLog2 in every direction
+	while (_nodes[_root].level < stepLog2 + 2 || _nodes[Centre(_root)].population != _nodes[_root].population)
+	{
+		_root = Expand(_root);
+	}
+
+	_root = Successor(Expand(_root), stepLog2);
+	_generation += uint64_t{ 1 } << stepLog2;
+}
+
+void HashLife::AdvanceBy(uint64_t generations)
+{
+	ML_METHOD;
+
+	// one step per set bit, biggest first
+	for (int bit = 63; bit >= 0; bit--)
+	{
+		if ((generations >> bit) & 1)
+		{
+			Step(gsl::narrow_cast<uint8_t>(bit));
+		}
+	}
+}
+
+HashLife::NodeId HashLife::SetCell(NodeId node, int64_t x, int64_t y, bool alive)
+{
+	const Node n = _nodes[node];
+
+	// x and y are relative to the center of the node
+	if (n.level == 1)
+	{
+		const NodeId cell = alive ? Alive : Dead;
+		if (y < 0)
+		{
+			return (x < 0) ? Join(cell, n.ne, n.sw, n.se) : Join(n.nw, cell, n.sw, n.se);
+		}
+		return (x < 0) ? Join(n.nw, n.ne, cell, n.se) : Join(n.nw, n.ne, n.sw, cell);
+	}
+
+	const int64_t quarter = int64_t{ 1 } << (n.level - 2);
+	if (y < 0)
+	{
+		if (x < 0)
+		{
+			return Join(SetCell(n.nw, x + quarter, y + quarter, alive), n.ne, n.sw, n.se);
+		}
+		return Join(n.nw, SetCell(n.ne, x - quarter, y + quarter, alive), n.sw, n.se);
+	}
+
+	if (x < 0)
+	{
+		return Join(n.nw, n.ne, SetCell(n.sw, x + quarter, y - quarter, alive), n.se);
+	}
+	return Join(n.nw, n.ne, n.sw, SetCell(n.se, x - quarter, y - quarter, alive));
+}
+
+void HashLife::SetCell(int64_t x, int64_t y, bool alive)
+{
+	while (true)
+	{
+		const int64_t half = int64_t{ 1 } << (_nodes[_root].level - 1);
+		if (x >= -half && x < half && y >= -half && y < half)
+		{
+			break;
+		}
+		_root = Expand(_root);
+	}
+
+	_root = SetCell(_root, x, y, alive);
+}
+
+bool HashLife::GetCell(int64_t x, int64_t y) const
+{
+	NodeId node = _root;
+	const int64_t half = int64_t{ 1 } << (_nodes[node].level - 1);
+	if (x < -half || x >= half || y < -half || y >= half)
+	{
+		return false;
+	}
+
+	// walk down towards the cell, keeping x and y relative to the center of the node
+	while (_nodes[node].level > 0 && _nodes[node].population > 0)
+	{
+		const Node& n = _nodes[node];
+		const int64_t quarter = (n.level > 1) ? int64_t{ 1 } << (n.level - 2) : 0;
+		if (y < 0)
+		{
+			node = (x < 0) ? n.nw : n.ne;
+			y += quarter;
+		}
+		else
+		{
+			node = (x < 0) ? n.sw : n.se;
+			y -= quarter;
+		}
+		x += (x < 0) ? quarter : -quarter;
+	}
+	return node == Alive;
+}
+
+void HashLife::LoadShape(Shape& shape, int64_t left, int64_t top)
+{
+	ML_METHOD;
+
+	for (uint16_t y = 0; y < shape.Height(); y++)
+	{
+		for (uint16_t x = 0; x < shape.Width(); x++)
+		{
+			if (shape.IsAlive(x, y))
+			{
+				SetCell(left + x, top + y, true);
+			}
+		}
+	}
+}
+
+void HashLife::CopyToBoard(Board& board, int64_t left, int64_t top) const
+{
+	ML_METHOD;
+
+	board.Clear();
+
+	const int64_t half = int64_t{ 1 } << (_nodes[_root].level - 1);
+	CopyToBoard(board, _root, -half, -half, left, top);
+}
+
+// nodeLeft and nodeTop are the universe coordinates of the node's top left cell
+void HashLife::CopyToBoard(Board& board, NodeId node, int64_t nodeLeft, int64_t nodeTop, int64_t left, int64_t top) const
+{
+	const Node& n = _nodes[node];
+	if (n.population == 0)
+	{
+		return;
+	}
+
+	// skip nodes that are outside the window
+	const int64_t size = int64_t{ 1 } << n.level;
+	if (nodeLeft + size <= left || nodeLeft >= left + board.Width() || nodeTop + size <= top || nodeTop >= top + board.Height())
+	{
+		return;
+	}
+
+	if (n.level == 0)
+	{
+		board.TurnCellOn(GridPoint{ gsl::narrow_cast<uint16_t>(nodeLeft - left), gsl::narrow_cast<uint16_t>(nodeTop - top) }, true);
+		return;
+	}
+
+	const int64_t half = size / 2;
+	CopyToBoard(board, n.nw, nodeLeft, nodeTop, left, top);
+	CopyToBoard(board, n.ne, nodeLeft + half, nodeTop, left, top);
+	CopyToBoard(board, n.sw, nodeLeft, nodeTop + half, left, top);
+	CopyToBoard(board, n.se, nodeLeft + half, nodeTop + half, left, top);
+}
+
+// the node for the square of cells in a leaf's bits that starts at (x, y)
+HashLife::NodeId HashLife::FromCells(uint64_t cells, uint32_t x, uint32_t y, uint8_t level)
+{
+	if (level == 0)
+	{
+		return ((cells >> ((y * 8) + x)) & 1) ? Alive : Dead;
+	}
+
+	const uint32_t half = 1u << (level - 1);
+	return Join(FromCells(cells, x, y, level - 1), FromCells(cells, x + half, y, level - 1), FromCells(cells, x, y + half, level - 1), FromCells(cells, x + half, y + half, level - 1));
+}
+
+// a leaf's level 3 node, made of 4x4 quarters looked up in quarters, which is indexed by the quarter's 16 cells
+// and starts out all None; most of the 65536 quarters repeat, so a leaf usually costs one Join instead of 85
+HashLife::NodeId HashLife::FromLeaf(uint64_t cells, std::vector<NodeId>& quarters)
+{
+	std::array<NodeId, 4> nodes{};
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		const uint32_t x = (i % 2) * 4;
+		const uint32_t y = (i / 2) * 4;
+		uint32_t key = 0;
+		for (uint32_t row = 0; row < 4; row++)
+		{
+			key |= gsl::narrow_cast<uint32_t>((cells >> (((y + row) * 8) + x)) & 0xF) << (row * 4);
+		}
+		if (quarters[key] == None)
+		{
+			quarters[key] = FromCells(cells, x, y, 2);
+		}
+		nodes[i] = quarters[key];
+	}
+	return Join(nodes[0], nodes[1], nodes[2], nodes[3]);
+}
+
+// the node for the square of the board that starts at (x, y), whatever is past the board's edges is dead
+HashLife::NodeId HashLife::FromBoard(const Board& board, uint32_t x, uint32_t y, uint8_t level, std::vector<NodeId>& quarters)
+{
+	if (x >= board.Width() || y >= board.Height())
+	{
+		return Empty(level);
+	}
+
+	if (level == 3)
+	{
+		uint64_t cells = 0;
+		for (uint32_t dy = 0; dy < 8 && y + dy < board.Height(); dy++)
+		{
+			for (uint32_t dx = 0; dx < 8 && x + dx < board.Width(); dx++)
+			{
+				if (board.Alive(gsl::narrow_cast<uint16_t>(x + dx), gsl::narrow_cast<uint16_t>(y + dy)))
+				{
+					cells |= uint64_t{ 1 } << ((dy * 8) + dx);
+				}
+			}
+		}
+		return cells == 0 ? Empty(3) : FromLeaf(cells, quarters);
+	}
+
+	const uint32_t half = 1u << (level - 1);
+	return Join(FromBoard(board, x, y, level - 1, quarters), FromBoard(board, x + half, y, level - 1, quarters), FromBoard(board, x, y + half, level - 1, quarters), FromBoard(board, x + half, y + half, level - 1, quarters));
+}
+
+void HashLife::LoadBoard(const Board& board)
+{
+	ML_METHOD;
+
+	Clear();
+
+	const uint32_t side = std::max(board.Width(), board.Height());
+	uint8_t level = 3;
+	while ((1u << level) < side)
+	{
+		level++;
+	}
+	std::vector<NodeId> quarters(QuarterCount, None);
+	_root = FromBoard(board, 0, 0, level, quarters);
+	_generation = board.Generation();
+}
+
+bool HashLife::LoadMacrocell(const std::filesystem::path& path)
+{
+	ML_METHOD;
+
+	const MappedFile file(path);
+	if (!file.IsOpen())
+	{
+		Clear();
+		return false;
+	}
+	return LoadMacrocell(file.Text());
+}
+
+bool HashLife::LoadMacrocell(std::string_view text)
+{
+	ML_METHOD;
+
+	Clear();
+
+	// the node each line became, line 0 is the empty child
+	std::vector<NodeId> lines{ None };
+	std::vector<NodeId> quarters(QuarterCount, None);
+	_index.reserve(text.size() / 32);
+	MacrocellReader reader(text);
+	MacrocellNode line;
+	bool valid = true;
+	while (valid && reader.Next(line))
+	{
+		NodeId id = None;
+		if (line.leaf)
+		{
+			id = FromLeaf(line.cells, quarters);
+		}
+		else if (line.level == 1)
+		{
+			// cell states, anything but 0 is alive
+			const auto state = [](uint32_t s) noexcept { return s != 0 ? Alive : Dead; };
+			id = Join(state(line.children[0]), state(line.children[1]), state(line.children[2]), state(line.children[3]));
+		}
+		else
+		{
+			std::array<NodeId, 4> children{};
+			for (size_t i = 0; i < children.size(); i++)
+			{
+				const uint32_t child = line.children[i];
+				children[i] = (child == 0) ? Empty(line.level - 1) : lines[child];
+				valid = valid && _nodes[children[i]].level == line.level - 1;
+			}
+			id = Join(children[0], children[1], children[2], children[3]);
+		}
+		lines.push_back(id);
+	}
+
+	// a rule HashLife can't run would make a different pattern of it
+	Rule rule;
+	if (reader.Failed() || !valid || (!reader.RuleText().empty() && (!Rule::Parse(reader.RuleText(), rule) || rule.IsGenerations())))
+	{
+		ML_TRACE("Not a macrocell pattern HashLife can run, stopped at node {}", reader.Lines());
+		Clear();
+		return false;
+	}
+
+	_birth = gsl::narrow_cast<uint16_t>(rule.Birth() & ~1u);
+	_survival = rule.Survival();
+	_root = (lines.size() > 1) ? lines.back() : Empty(3);
+	while (_nodes[_root].level < 3)
+	{
+		_root = Expand(_root);
+	}
+	_generation = reader.Generation();
+	return true;
+}
+
+// a leaf's cells from a level 3 node, bit (y * 8 + x) is the cell at (x, y)
+uint64_t HashLife::LeafCells(NodeId node) const
+{
+	uint64_t cells = 0;
+	const Node& leaf = _nodes[node];
+	const std::array<NodeId, 4> quarters{ leaf.nw, leaf.ne, leaf.sw, leaf.se };
+	for (uint32_t q = 0; q < 4; q++)
+	{
+		const Node& quarter = _nodes[quarters[q]];
+		const std::array<NodeId, 4> pairs{ quarter.nw, quarter.ne, quarter.sw, quarter.se };
+		for (uint32_t p = 0; p < 4; p++)
+		{
+			const Node& pair = _nodes[pairs[p]];
+			const uint32_t x = ((q % 2) * 4) + ((p % 2) * 2);
+			const uint32_t y = ((q / 2) * 4) + ((p / 2) * 2);
+			const uint64_t bits = (pair.nw == Alive ? 1u : 0u) | (pair.ne == Alive ? 2u : 0u) | (pair.sw == Alive ? 0x100u : 0u) | (pair.se == Alive ? 0x200u : 0u);
+			cells |= bits << ((y * 8) + x);
+		}
+	}
+	return cells;
+}
+
+bool HashLife::SaveMacrocell(std::ostream& stream) const
+{
+	ML_METHOD;
+
+	MacrocellWriter writer(stream, Rule(_birth, _survival).ToString(), _generation);
+
+	// the line each node was written as, 0 until it's written
+	std::vector<uint32_t> lines(_nodes.size(), 0);
+	SaveMacrocell(_root, writer, lines);
+	return writer.Good();
+}
+
+// children first, so every line only refers to lines above it
+uint32_t HashLife::SaveMacrocell(NodeId node, MacrocellWriter& writer, std::vector<uint32_t>& lines) const
+{
+	const Node& n = _nodes[node];
+	if (n.population == 0 || lines[node] != 0)
+	{
+		return lines[node];
+	}
+
+	if (n.level == 3)
+	{
+		lines[node] = writer.Leaf(LeafCells(node));
+	}
+	else
+	{
+		const uint32_t nw = SaveMacrocell(n.nw, writer, lines);
+		const uint32_t ne = SaveMacrocell(n.ne, writer, lines);
+		const uint32_t sw = SaveMacrocell(n.sw, writer, lines);
+		const uint32_t se = SaveMacrocell(n.se, writer, lines);
+		lines[node] = writer.Node(n.level, nw, ne, sw, se);
+	}
+	return lines[node];
+}
+
+size_t HashLife::MemoryUsage() const noexcept
+{
+	// each hash table entry is a heap node with the key, the id and a next pointer
+	constexpr size_t entry = sizeof(NodeKey) + sizeof(NodeId) + 2 * sizeof(void*);
+	return _nodes.capacity() * sizeof(Node) + _index.size() * entry + _index.bucket_count() * sizeof(void*);
+}
+
+// keeps the nodes the root is made of and forgets all results
+void HashLife::CollectGarbage()
+{
+	ML_METHOD;
+
+	std::vector<uint8_t> keep(_nodes.size(), 0);
+	keep[Dead] = 1;
+	keep[Alive] = 1;
+
+	std::vector<NodeId> pending{ _root };
+	while (!pending.empty())
+	{
+		const NodeId id = pending.back();
+		pending.pop_back();
+		if (keep[id])
+		{
+			continue;
+		}
+
+		keep[id] = 1;
+		const Node& n = _nodes[id];
+		pending.insert(pending.end(), { n.nw, n.ne, n.sw, n.se });
+	}
+
+	// children are always created before their parents, so one pass in order can remap them
+	std::vector<NodeId> remap(_nodes.size(), None);
+	std::vector<Node> nodes;
+	nodes.reserve(std::count(keep.begin(), keep.end(), uint8_t{ 1 }));
+	_index.clear();
+
+	for (size_t id = 0; id < _nodes.size(); id++)
+	{
+		if (!keep[id])
+		{
+			continue;
+		}
+
+		Node n = _nodes[id];
+		n.full = None;
+		n.partial = None;
+		const auto newId = gsl::narrow_cast<NodeId>(nodes.size());
+		if (n.level > 0)
+		{
+			n.nw = remap[n.nw];
+			n.ne = remap[n.ne];
+			n.sw = remap[n.sw];
+			n.se = remap[n.se];
+			_index.emplace(NodeKey{ n.nw, n.ne, n.sw, n.se }, newId);
+		}
+		remap[id] = newId;
+		nodes.push_back(n);
+	}
+
+	_nodes.swap(nodes);
+	_root = remap[_root];
+	_empty.clear();
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Shape.h"
+
+class Board;
+class MacrocellWriter;
+
+// HashLife stores an unbounded Life-like universe as a quadtree of canonical (hash-consed) nodes.
+// Identical squares anywhere in space or time share one node, and each node remembers its
+// future, so regular patterns (guns, breeders, spaceships) can be advanced by millions of
+// generations in a handful of steps.
+//
+// Cell (0,0) is just below and right of the center of the root node; x grows right, y grows down, like Board.
+// The default rule is Conway's B3/S23, any B/S rule can be given as neighbor count bit masks
+// (except B0, empty space has to stay empty).
+class HashLife
+{
+public:
+    // bit n of birth/survival is set if a cell with n live neighbors is born/survives
+    explicit HashLife(uint16_t birth = 0b000001000, uint16_t survival = 0b000001100);
+    ~HashLife() = default;
+
+    // copy/move not needed
+    HashLife(HashLife&& b) = delete;
+    HashLife(HashLife& b) = delete;
+    HashLife& operator=(HashLife&& b) = delete;
+    HashLife& operator=(HashLife& b) = delete;
+
+    void Clear();
+
+    // places the shape with its top left cell at (left, top)
+    void LoadShape(Shape& shape, int64_t left, int64_t top);
+    void SetCell(int64_t x, int64_t y, bool alive);
+    [[nodiscard]] bool GetCell(int64_t x, int64_t y) const;
+
+    void AdvanceBy(uint64_t generations);
+
+    // clears the board and copies the window of the universe that starts at (left, top) into it
+    void CopyToBoard(Board& board, int64_t left, int64_t top) const;
+
+    // replaces the universe with the board, its top left cell at the root's top left corner, -2^(level - 1) on both axes
+    void LoadBoard(const Board& board);
+
+    // replaces the universe with a Golly macrocell pattern, and takes its rule and generation
+    // the file is mapped rather than read, and each line becomes a node as it's read, so the pattern is never expanded into cells
+    // false, with the universe cleared, if it isn't a macrocell file or its rule isn't a B/S rule
+    bool LoadMacrocell(const std::filesystem::path& path);
+    bool LoadMacrocell(std::string_view text);
+
+    // writes the universe as a macrocell pattern, each distinct node once, straight to the stream
+    bool SaveMacrocell(std::ostream& stream) const;
+
+    [[nodiscard]] uint64_t Generation() const noexcept
+    {
+        return _generation;
+    }
+
+    [[nodiscard]] uint64_t Population() const noexcept
+    {
+        return _nodes[_root].population;
+    }
+
+    [[nodiscard]] size_t NodeCount() const noexcept
+    {
+        return _nodes.size();
+    }
+
+    // approximate bytes used by the nodes and the hash table
+    [[nodiscard]] size_t MemoryUsage() const noexcept;
+
+    // once MemoryUsage goes over the budget, nodes that aren't part of the current universe are
+    // collected (and all remembered futures are forgotten) before the next step
+    void MemoryBudget(size_t bytes) noexcept
+    {
+        _memoryBudget = bytes;
+    }
+
+    [[nodiscard]] size_t MemoryBudget() const noexcept
+    {
+        return _memoryBudget;
+    }
+
+    void CollectGarbage();
+
+private:
+    using NodeId = uint32_t;
+    static constexpr NodeId None{ 0xFFFFFFFF };
+
+    // level 0 nodes are single cells, a level n node is 2^n x 2^n cells
+    struct Node
+    {
+        NodeId nw{ None };
+        NodeId ne{ None };
+        NodeId sw{ None };
+        NodeId se{ None };
+        // the center half of this node advanced 2^(level - 2) generations
+        NodeId full{ None };
+        // the center half of this node advanced 2^_stepLog2 generations, when that's less than full
+        NodeId partial{ None };
+        uint64_t population{ 0 };
+        uint8_t level{ 0 };
+    };
+
+    struct NodeKey
+    {
+        NodeId nw;
+        NodeId ne;
+        NodeId sw;
+        NodeId se;
+
+        bool operator==(const NodeKey& other) const noexcept
+        {
+            return nw == other.nw && ne == other.ne && sw == other.sw && se == other.se;
+        }
+    };
+
+    struct NodeKeyHash
+    {
+        size_t operator()(const NodeKey& key) const noexcept
+        {
+            uint64_t h = (uint64_t{ key.nw } << 32 | key.ne) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t{ key.sw } << 32 | key.se) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    static constexpr NodeId Dead{ 0 };
+    static constexpr NodeId Alive{ 1 };
+
+    // every 4x4 square of cells, for FromLeaf
+    static constexpr size_t QuarterCount{ 1 << 16 };
+
+    NodeId Join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+    NodeId Empty(uint8_t level);
+    NodeId Expand(NodeId node);
+    NodeId Centre(NodeId node);
+    NodeId Successor(NodeId node, uint8_t stepLog2);
+    NodeId StepLevel2(NodeId node);
+    NodeId SetCell(NodeId node, int64_t x, int64_t y, bool alive);
+    NodeId FromCells(uint64_t cells, uint32_t x, uint32_t y, uint8_t level);
+    NodeId FromLeaf(uint64_t cells, std::vector<NodeId>& quarters);
+    NodeId FromBoard(const Board& board, uint32_t x, uint32_t y, uint8_t level, std::vector<NodeId>& quarters);
+    uint64_t LeafCells(NodeId node) const;
+    uint32_t SaveMacrocell(NodeId node, MacrocellWriter& writer, std::vector<uint32_t>& lines) const;
+    void CopyToBoard(Board& board, NodeId node, int64_t nodeLeft, int64_t nodeTop, int64_t left, int64_t top) const;
+    void Step(uint8_t stepLog2);
+    void ForgetPartialResults() noexcept;
+
+    std::vector<Node> _nodes;
+    std::unordered_map<NodeKey, NodeId, NodeKeyHash> _index;
+    std::vector<NodeId> _empty;
+
+    NodeId _root{ None };
+    uint64_t _generation{ 0 };
+    size_t _memoryBudget{ size_t{ 512 } * 1024 * 1024 };
+    uint16_t _birth;
+    uint16_t _survival;
+    uint8_t _stepLog2{ 0 };
+};
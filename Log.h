@@ -4,6 +4,9 @@
 #include <map>
 #include <utility>
 #include <source_location>
+
+// headless builds have no spdlog and never log, only the empty macros below are defined
+#ifndef ML_HEADLESS
 #include <format>
 
 #define SPDLOG_USE_STD_FORMAT
@@ -75,6 +78,7 @@ namespace Util
 	};
 
 }
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Tagged logs (prefer these!)                                                                                      //
@@ -109,6 +113,8 @@ namespace Util
 #define ML_ERROR(...)	
 #define HZ_FATAL(...)	
 #endif
+
+#ifndef ML_HEADLESS
 namespace Util
 {
 	//template<typename... Args>
@@ -161,3 +167,4 @@ namespace Util
 		if (logger) logger->error("{0}", prefix);
 	}
 }
+#endif
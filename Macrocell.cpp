@@ -0,0 +1,202 @@
+#include "pch.h"
+
+#include "Macrocell.h"
+
+#include <charconv>
+
+#include <gsl/gsl>
+
+namespace
+{
+	[[nodiscard]] bool IsSpace(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// reads a number and the spaces after it, false if there's no number
+	template <typename T>
+	bool ReadNumber(std::string_view& text, T& number) noexcept
+	{
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+		if (error != std::errc{})
+		{
+			return false;
+		}
+		text.remove_prefix(gsl::narrow_cast<size_t>(end - text.data()));
+		while (!text.empty() && IsSpace(text.front()))
+		{
+			text.remove_prefix(1);
+		}
+		return true;
+	}
+}
+
+std::string_view MacrocellReader::NextLine() noexcept
+{
+	const size_t start = _position;
+	const size_t end = _text.find('\n', start);
+	_position = (end == std::string_view::npos) ? _text.size() : end + 1;
+	return _text.substr(start, ((end == std::string_view::npos) ? _text.size() : end) - start);
+}
+
+bool MacrocellReader::Next(MacrocellNode& node) noexcept
+{
+	while (!_failed && _position < _text.size())
+	{
+		std::string_view line = NextLine();
+		while (!line.empty() && IsSpace(line.back()))
+		{
+			line.remove_suffix(1);
+		}
+
+		// the first line says what the file is
+		if (!_header)
+		{
+			_header = line.starts_with("[M2]");
+			_failed = !_header;
+			continue;
+		}
+
+		if (line.empty())
+		{
+			continue;
+		}
+
+		if (line.front() == '#')
+		{
+			if (line.starts_with("#R"))
+			{
+				_rule = line.substr(2);
+				while (!_rule.empty() && IsSpace(_rule.front()))
+				{
+					_rule.remove_prefix(1);
+				}
+			}
+			else if (line.starts_with("#G"))
+			{
+				std::string_view number = line.substr(2);
+				while (!number.empty() && IsSpace(number.front()))
+				{
+					number.remove_prefix(1);
+				}
+				_failed = !ReadNumber(number, _generation);
+			}
+			continue;
+		}
+
+		const bool read = (line.front() >= '0' && line.front() <= '9') ? Node(line, node) : Leaf(line, node);
+		if (!read)
+		{
+			_failed = true;
+			return false;
+		}
+		_lines++;
+		return true;
+	}
+	return false;
+}
+
+bool MacrocellReader::Leaf(std::string_view line, MacrocellNode& node) noexcept
+{
+	node.level = 3;
+	node.leaf = true;
+	node.cells = 0;
+	uint32_t x = 0;
+	uint32_t y = 0;
+	for (const char c : line)
+	{
+		if (c == '$')
+		{
+			x = 0;
+			y++;
+			continue;
+		}
+		if ((c != '.' && c != '*') || x > 7 || y > 7)
+		{
+			return false;
+		}
+		if (c == '*')
+		{
+			node.cells |= uint64_t{ 1 } << ((y * 8) + x);
+		}
+		x++;
+	}
+	return true;
+}
+
+// level nw ne sw se, where the children have to be lines that came before
+bool MacrocellReader::Node(std::string_view line, MacrocellNode& node) noexcept
+{
+	uint32_t level = 0;
+	if (!ReadNumber(line, level) || level < 1 || level > MaxLevel)
+	{
+		return false;
+	}
+	node.level = gsl::narrow_cast<uint8_t>(level);
+	node.leaf = false;
+	node.cells = 0;
+
+	for (uint32_t& child : node.children)
+	{
+		if (!ReadNumber(line, child) || (level > 1 && child > _lines))
+		{
+			return false;
+		}
+	}
+	return line.empty();
+}
+
+MacrocellWriter::MacrocellWriter(std::ostream& stream, std::string_view rule, uint64_t generation) : _stream(stream)
+{
+	_stream << "[M2] (ModernLife)\n";
+	if (!rule.empty())
+	{
+		_stream << "#R " << rule << '\n';
+	}
+	if (generation != 0)
+	{
+		_stream << "#G " << generation << '\n';
+	}
+}
+
+uint32_t MacrocellWriter::Leaf(uint64_t cells)
+{
+	// at most 8 rows of 8 cells and a $ each
+	std::array<char, 73> line{};
+	size_t length = 0;
+	for (uint32_t y = 0; y < 8 && (cells >> (y * 8)) != 0; y++)
+	{
+		uint64_t row = (cells >> (y * 8)) & 0xFF;
+		while (row != 0)
+		{
+			line[length++] = (row & 1) ? '*' : '.';
+			row >>= 1;
+		}
+		line[length++] = '$';
+	}
+	// an empty leaf still needs its line, for the numbering
+	if (length == 0)
+	{
+		line[length++] = '$';
+	}
+	line[length++] = '\n';
+	_stream.write(line.data(), gsl::narrow_cast<std::streamsize>(length));
+	return ++_lines;
+}
+
+uint32_t MacrocellWriter::Node(uint8_t level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+	// five numbers of up to 10 digits and their separators
+	std::array<char, 64> line{};
+	char* end = line.data();
+	char* const last = line.data() + line.size();
+	end = std::to_chars(end, last, level).ptr;
+	for (const uint32_t child : { nw, ne, sw, se })
+	{
+		*end++ = ' ';
+		end = std::to_chars(end, last, child).ptr;
+	}
+	*end++ = '\n';
+	_stream.write(line.data(), gsl::narrow_cast<std::streamsize>(end - line.data()));
+	return ++_lines;
+}
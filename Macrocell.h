@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+// Golly's macrocell format (.mc) writes a quadtree bottom up, one node a line, and writes identical nodes only once,
+// so a pattern billions of cells across that repeats itself fits in a few megabytes:
+//
+// [M2] (ModernLife)
+// #R B3/S23                    the rule
+// #G 1000                      the generation, if it isn't 0
+// .*$..*$***$                  an 8x8 leaf, each row ends in $, * is alive; dead cells and rows at the end are left out
+// 4 1 0 0 1                    a node 2^4 cells across and its nw, ne, sw and se children as line numbers
+//
+// node lines are numbered from 1 and 0 is an empty child; the last line is the whole pattern, centered on (0, 0)
+// files for rules with more states use level 1 nodes of four cell states instead of leaves
+
+struct MacrocellNode
+{
+    // the node is 2^level cells across, a leaf is level 3
+    uint8_t level{ 0 };
+    bool leaf{ false };
+
+    // a leaf's cells, bit (y * 8 + x) is the cell at (x, y)
+    uint64_t cells{ 0 };
+
+    // nw, ne, sw, se as line numbers, or as cell states at level 1
+    std::array<uint32_t, 4> children{};
+};
+
+// reads node lines straight from the text, e.g. a mapped file, without copying any of it
+// comment lines are skipped, except #R and #G
+class MacrocellReader
+{
+public:
+    explicit MacrocellReader(std::string_view text) noexcept : _text(text)
+    {
+    }
+
+    // the next node; false at the end of the text or at a line that isn't a node, Failed tells which
+    bool Next(MacrocellNode& node) noexcept;
+
+    [[nodiscard]] bool Failed() const noexcept
+    {
+        return _failed;
+    }
+
+    // the node lines read so far, which is the line number of the last one
+    [[nodiscard]] uint32_t Lines() const noexcept
+    {
+        return _lines;
+    }
+
+    // part of the text, empty if there's no #R line before the nodes read so far
+    [[nodiscard]] std::string_view RuleText() const noexcept
+    {
+        return _rule;
+    }
+
+    [[nodiscard]] uint64_t Generation() const noexcept
+    {
+        return _generation;
+    }
+
+    // deepest a node can be, so coordinates inside the root fit in an int64_t
+    static constexpr uint8_t MaxLevel{ 62 };
+
+private:
+    [[nodiscard]] std::string_view NextLine() noexcept;
+    bool Leaf(std::string_view line, MacrocellNode& node) noexcept;
+    bool Node(std::string_view line, MacrocellNode& node) noexcept;
+
+    std::string_view _text;
+    size_t _position{ 0 };
+    std::string_view _rule;
+    uint64_t _generation{ 0 };
+    uint32_t _lines{ 0 };
+    bool _header{ false };
+    bool _failed{ false };
+};
+
+// writes nodes as they're given, children first, and numbers them; the caller remembers the numbers so each node is written once
+// every line goes straight to the stream, nothing is kept
+class MacrocellWriter
+{
+public:
+    MacrocellWriter(std::ostream& stream, std::string_view rule, uint64_t generation);
+
+    // the line number of the node, for its parent
+    uint32_t Leaf(uint64_t cells);
+    uint32_t Node(uint8_t level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+
+    [[nodiscard]] bool Good() const
+    {
+        return _stream.good();
+    }
+
+private:
+    std::ostream& _stream;
+    uint32_t _lines{ 0 };
+};
@@ -39,6 +39,7 @@
 
 #include "Log.h"
 #include "Shape.h"
+#include "HashLife.h"
 #include "Renderer.h"
 #include "TimerHelper.h"
 #include "fpscounter.h"
@@ -90,9 +91,20 @@ namespace winrt::ModernLife::implementation
 
         // initialize board
         //_board.Reserve(gsl::narrow_cast<size_t>(sliderBoardWidth().Maximum() * sliderBoardWidth().Maximum()));
+        _board.CycleDetection(CycleAction::Replay);
+        _board.HashTracking(true);
+        _board.RewindMemory(RewindMemoryCap);
         _board.Resize(BoardWidth(), BoardHeight(), MaxAge());
         RandomizeBoard();
 
+        // the board belongs to the simulation thread from here on
+        _simulation.Rules(_ruleset);
+        _simulation.Start();
+
+        // frames should fit in the timer's interval
+        _governor.Target(std::chrono::milliseconds{ 1000 / timer.FPS() });
+        _governor.DetailLevels(Renderer::DetailLevels);
+
         // intitialize renderer
         _renderer.Attach(_canvasDevice, _dpi, MaxAge());
         _renderer.Size(BoardWidth(), BoardHeight());
@@ -103,7 +115,7 @@ namespace winrt::ModernLife::implementation
     void MainWindow::Pause()
     {
         SetStatus("Paused. Press Play to start. Left mouse button to draw. Right right mouse button to erase.");
-        timer.Stop();
+        _simulation.Running(false);
         GoButton().Icon(Microsoft::UI::Xaml::Controls::SymbolIcon(Microsoft::UI::Xaml::Controls::Symbol::Play));
         GoButton().Label(L"Play");
     }
@@ -111,7 +123,7 @@ namespace winrt::ModernLife::implementation
     void MainWindow::Play()
     {
         SetStatus("Running... Left mouse button to draw. Right right mouse button to erase.");
-        timer.Start();
+        _simulation.Running(true);
         GoButton().Icon(Microsoft::UI::Xaml::Controls::SymbolIcon(Microsoft::UI::Xaml::Controls::Symbol::Pause));
         GoButton().Label(L"Pause");
     }
@@ -123,8 +135,9 @@ namespace winrt::ModernLife::implementation
         // prep the play button
         Pause();
 
-        // start the FPSCounter
+        // start the FPSCounter and drawing
         fps.Start();
+        timer.Start();
 
         // draw the initial population
         InvalidateIfNeeded();
@@ -133,22 +146,26 @@ namespace winrt::ModernLife::implementation
     void MainWindow::OnTick(winrt::Microsoft::UI::Dispatching::DispatcherQueueTimer const&, IInspectable const&)
     {
         ML_METHOD;
-        canvasBoard().Invalidate();
+
+        // only draw when there's a generation or an edit that hasn't been drawn
+        if (_simulation.HasNewSnapshot())
+        {
+            canvasBoard().Invalidate();
+        }
     }
 
     void MainWindow::PumpProperties()
     {
         _propertyChanged(*this, PropertyChangedEventArgs{ L"FPSAverage" });
+        _propertyChanged(*this, PropertyChangedEventArgs{ L"GenerationRate" });
         _propertyChanged(*this, PropertyChangedEventArgs{ L"GenerationCount" });
         _propertyChanged(*this, PropertyChangedEventArgs{ L"LiveCount" });
     }
 
+    // the timer draws every new snapshot, this is for changes to the picture that don't change the board
     void MainWindow::InvalidateIfNeeded()
     {
-        if (!timer.IsRunning())
-        {
-            canvasBoard().Invalidate();
-        }
+        canvasBoard().Invalidate();
         PumpProperties();
     }
 
@@ -161,7 +178,7 @@ namespace winrt::ModernLife::implementation
         initializeWithWindow->Initialize(GetWindowHandle());
         openPicker.ViewMode(Windows::Storage::Pickers::PickerViewMode::List);
         openPicker.SuggestedStartLocation(Windows::Storage::Pickers::PickerLocationId::Desktop);
-        openPicker.FileTypeFilter().ReplaceAll({ L".cells" });
+        openPicker.FileTypeFilter().ReplaceAll({ L".cells", L".rle", L".lif", L".life", L".mc" });
         Windows::Storage::StorageFile sfile = co_await openPicker.PickSingleFileAsync();
         if (sfile == nullptr)
         {
@@ -194,10 +211,20 @@ namespace winrt::ModernLife::implementation
         // keep the current board playing in the background while the user picks a file
         auto filepicker = co_await PickShapeFileAsync();
         std::string file = winrt::to_string(filepicker);
+        if (file.empty())
+        {
+            co_return;
+        }
 
         // load the shape
         Shape shape(file);
-        shape.Load();
+        if (!shape.Load())
+        {
+            std::string message = shape.Name() + " isn't a pattern ModernLife can read.";
+            SetStatus(message);
+            ShowMessageBox(L"Can't load shape", winrt::to_hstring(message));
+            co_return;
+        }
 
         const uint16_t maxsize = gsl::narrow_cast<uint16_t>(sliderBoardWidth().Maximum());
         // if it's too big, bail
@@ -228,13 +255,84 @@ namespace winrt::ModernLife::implementation
         }
         BoardWidth(size);
 
-        // Copy the shape to the board
-        const uint16_t startX = (_board.Width() - shape.Width()) / 2;
-        const uint16_t startY = (_board.Height() - shape.Height()) / 2;
-        _board.CopyShape(shape, startX, startY);
-        SetStatus("Loaded " + shape.Name());
+        // run it in the rule the file asks for, if there's one the board can run
+        std::string status = "Loaded " + shape.Name();
+        if (!shape.RuleText().empty())
+        {
+            Rule rule;
+            if (Rule::Parse(shape.RuleText(), rule))
+            {
+                _rule = rule;
+                _simulation.Rules(rule);
+                dropdownRules().Content(winrt::box_value(winrt::to_hstring(rule.ToString())));
+            }
+            else
+            {
+                status += ", rule " + shape.RuleText() + " isn't supported, kept the current rule";
+            }
+        }
+
+        // Copy the shape to the board, after the resize and the clear above
+        SetStatus(status);
+        _simulation.Post([shape](Board& board) mutable
+            {
+                const uint16_t startX = (board.Width() - shape.Width()) / 2;
+                const uint16_t startY = (board.Height() - shape.Height()) / 2;
+                board.CopyShape(shape, startX, startY);
+            });
+        co_return;
+    }
 
-        InvalidateIfNeeded();
+    Windows::Foundation::IAsyncOperation<winrt::hstring> MainWindow::PickSaveFileAsync()
+    {
+        ML_METHOD;
+
+        Windows::Storage::Pickers::FileSavePicker savePicker;
+        auto initializeWithWindow{ savePicker.as<::IInitializeWithWindow>() };
+        initializeWithWindow->Initialize(GetWindowHandle());
+        savePicker.SuggestedStartLocation(Windows::Storage::Pickers::PickerLocationId::Desktop);
+        savePicker.FileTypeChoices().Insert(L"Golly macrocell", winrt::single_threaded_vector<hstring>({ L".mc" }));
+        savePicker.SuggestedFileName(L"ModernLife");
+        Windows::Storage::StorageFile sfile = co_await savePicker.PickSaveFileAsync();
+        if (sfile == nullptr)
+        {
+            ML_TRACE("File save picker canceled.");
+            co_return winrt::hstring(L"");
+        }
+        co_return sfile.Path();
+    }
+
+    winrt::fire_and_forget MainWindow::SaveShape_Click([[maybe_unused]] winrt::Windows::Foundation::IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e)
+    {
+        ML_METHOD;
+
+        auto filepicker = co_await PickSaveFileAsync();
+        if (filepicker.empty())
+        {
+            co_return;
+        }
+
+        // the board is read on the simulation thread, between generations, and goes through HashLife
+        // so repeated parts of it are written once; only live cells are saved, a Generations rule as its B/S part
+        _simulation.Post([path = std::filesystem::path{ filepicker.c_str() }, rule = _rule, queue = this->DispatcherQueue(), weak = get_weak()](Board& board)
+            {
+                HashLife life(rule.Birth(), rule.Survival());
+                life.LoadBoard(board);
+
+                std::ofstream stream(path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+                std::string status = std::format("Saved generation {} to {}", board.Generation(), path.filename().string());
+                if (!stream.is_open() || !life.SaveMacrocell(stream))
+                {
+                    status = "Couldn't save to " + path.string();
+                }
+                queue.TryEnqueue([weak, status]
+                    {
+                        if (auto self = weak.get())
+                        {
+                            self->SetStatus(status);
+                        }
+                    });
+            });
         co_return;
     }
 
@@ -268,6 +366,7 @@ namespace winrt::ModernLife::implementation
 
         bool on = (_PointerMode == PointerMode::Left);
 
+        std::vector<GridPoint> cells;
         for (const Microsoft::UI::Input::PointerPoint& point : e.GetIntermediatePoints(canvasBoard().as<Microsoft::UI::Xaml::UIElement>()))
         {
             const GridPoint g = _renderer.GetCellAtPoint(point.Position());
@@ -275,9 +374,15 @@ namespace winrt::ModernLife::implementation
             //ML_TRACE("Point {},{} Cell grid {},{}", point.Position().X, point.Position().Y, g.x, g.y);
             //SetStatus("Drawing. Left mouse button to draw. Right right mouse button to erase.");
 
-            _board.TurnCellOn(g, on);
+            cells.push_back(g);
         }
-        InvalidateIfNeeded();
+        _simulation.Post([cells = std::move(cells), on](Board& board)
+            {
+                for (const GridPoint& g : cells)
+                {
+                    board.TurnCellOn(g, on);
+                }
+            });
     }
 
     void MainWindow::OnPointerReleased([[maybe_unused]] winrt::Windows::Foundation::IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::Input::PointerRoutedEventArgs const& e) noexcept
@@ -329,7 +434,21 @@ namespace winrt::ModernLife::implementation
 
     void MainWindow::CanvasBoard_Draw([[maybe_unused]] Microsoft::Graphics::Canvas::UI::Xaml::CanvasControl  const& sender, Microsoft::Graphics::Canvas::UI::Xaml::CanvasDrawEventArgs const& args)
     {
-        _board.Update(_ruleset);
+        // the newest generation the simulation thread has published, it may be a few on by the time this frame is shown
+        const BoardSnapshot& snapshot = _simulation.Latest();
+        _shownGeneration = snapshot.generation;
+        _shownLiveCount = snapshot.liveCount;
+
+        // report a still life or an oscillator once, when it's found
+        const CycleInfo cycle = snapshot.cycle;
+        if (cycle.period != _reportedCycle.period || cycle.start != _reportedCycle.start)
+        {
+            _reportedCycle = cycle;
+            if (cycle.period != 0)
+            {
+                SetStatus(std::format("Period {} from generation {}, replaying it", cycle.period, cycle.start));
+            }
+        }
 
         if (ShowLegend())
         {
@@ -339,7 +458,14 @@ namespace winrt::ModernLife::implementation
         }
         else
         {
-            _renderer.Render(args.DrawingSession(), _board);
+            _renderer.Render(args.DrawingSession(), snapshot);
+
+            const RenderTimes& rendered = _renderer.LastRenderTimes();
+            if (_governor.AddFrame({ _simulation.LastStepTime(), _simulation.GenerationsPerStep(), rendered.offscreen, rendered.composite }))
+            {
+                ApplyGovernor();
+                SetStatus(std::format("Keeping frames under {} ms: {} generations a frame, {}", _governor.Target().count() / 1'000'000, _governor.GenerationsPerFrame(), _governor.Detail() == 0 ? "full detail" : "flat cells"));
+            }
         }
         fps.AddFrame();
         PumpProperties();
@@ -354,7 +480,7 @@ namespace winrt::ModernLife::implementation
     // property & event handlers
     void MainWindow::GoButton_Click([[maybe_unused]] IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e)
     {
-        if (timer.IsRunning())
+        if (_simulation.Running())
         {
             Pause();
         }
@@ -364,12 +490,33 @@ namespace winrt::ModernLife::implementation
         }
     }
 
+    void MainWindow::RewindButton_Click([[maybe_unused]] IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e)
+    {
+        Pause();
+
+        // the board is on the simulation thread, the status comes back to the UI thread
+        _simulation.Post([queue = this->DispatcherQueue(), weak = get_weak()](Board& board)
+            {
+                std::string status{ "No earlier generation to go back to" };
+                if (board.Rewind(1))
+                {
+                    status = std::format("Back to generation {}, generations {} to {} can be gone back to", board.Generation(), board.OldestGeneration(), board.NewestGeneration());
+                }
+                queue.TryEnqueue([weak, status]
+                    {
+                        if (auto self = weak.get())
+                        {
+                            self->SetStatus(status);
+                        }
+                    });
+            });
+    }
+
     void MainWindow::OnRandomizeBoard()
     {
         SetStatus("Board reset");
 
         RandomizeBoard();
-        InvalidateIfNeeded();
 
         StartGameLoop();
     }
@@ -378,7 +525,7 @@ namespace winrt::ModernLife::implementation
     {
         ML_METHOD;
 
-        _board.RandomizeBoard(RandomPercent() / 100.0f, MaxAge());
+        _simulation.Post([alivepct = RandomPercent() / 100.0f, maxage = MaxAge()](Board& board) { board.RandomizeBoard(alivepct, maxage); });
     }
 
     void MainWindow::OnCanvasDeviceChanged()
@@ -416,25 +563,23 @@ namespace winrt::ModernLife::implementation
     {
         ML_METHOD;
         SetStatus("Board resized");
-        // create the board, lock it in the case that OnTick is updating it
-        // we lock it because changing board parameters will call StartGameLoop()
+        // the renderer keeps showing the last frame until the resized board's first snapshot comes back
         Pause();
 
-        _board.Resize(BoardWidth(), BoardHeight(), MaxAge());
+        _simulation.Post([width = BoardWidth(), height = BoardHeight(), maxage = MaxAge()](Board& board) { board.Resize(width, height, maxage); });
         _renderer.Size(BoardWidth(), BoardHeight());
+        _governor.Reset();
+        ApplyGovernor();
 
         RandomizeBoard();
-        InvalidateIfNeeded();
 
         StartGameLoop();
     }
 
     void MainWindow::OnMaxAgeChanged()
     {
-        _board.MaxAge(MaxAge());
+        _simulation.Post([maxage = MaxAge()](Board& board) { board.MaxAge(maxage); });
         _renderer.SpriteMaxIndex(MaxAge());
-
-        InvalidateIfNeeded();
     }
 
     // boilerplate and standard Windows stuff below
@@ -533,12 +678,12 @@ namespace winrt::ModernLife::implementation
 
     [[nodiscard]] hstring MainWindow::LiveCount() const
     {
-        return winrt::to_hstring(_board.GetLiveCount());
+        return winrt::to_hstring(_shownLiveCount);
     }
 
     [[nodiscard]] hstring MainWindow::GenerationCount() const
     {
-        return winrt::to_hstring(_board.Generation());
+        return winrt::to_hstring(_shownGeneration);
     }
 
     [[nodiscard]] hstring MainWindow::FPSAverage() const
@@ -547,6 +692,12 @@ namespace winrt::ModernLife::implementation
         return winrt::to_hstring(f);
     }
 
+    [[nodiscard]] hstring MainWindow::GenerationRate() const
+    {
+        std::string g = std::format("{:.0f}", _simulation.MeasuredGenerationsPerSecond());
+        return winrt::to_hstring(g);
+    }
+
     [[nodiscard]] uint16_t MainWindow::RandomPercent() const noexcept
     {
         return _randompercent;
@@ -610,7 +761,28 @@ namespace winrt::ModernLife::implementation
         Microsoft::UI::Xaml::Controls::MenuFlyoutItem item = sender.as<Microsoft::UI::Xaml::Controls::MenuFlyoutItem>();
 		dropdownSpeed().Content(winrt::box_value(item.Text()));
 
-		timer.FPS(item.Tag().as<int>());
+        // positive tags are generations a second, negative ones generations per frame, and 0 is as fast as the board goes
+        // only the newest generation is drawn, so the display rate doesn't hold the board back
+        // the governor may take fewer generations per frame than asked for, to keep frames in time
+        const int tag = item.Tag().as<int>();
+        if (tag < 0)
+        {
+            _governor.MaxGenerationsPerFrame(gsl::narrow_cast<uint32_t>(-tag));
+            _simulation.StepsPerSecond(DisplayFPS);
+        }
+        else
+        {
+            _governor.MaxGenerationsPerFrame(1);
+            _simulation.StepsPerSecond(tag);
+        }
+        _governor.Reset();
+        ApplyGovernor();
+    }
+
+    void MainWindow::ApplyGovernor()
+    {
+        _renderer.Detail(static_cast<RenderDetail>(_governor.Detail()));
+        _simulation.GenerationsPerStep(_governor.GenerationsPerFrame());
     }
 
     void MainWindow::ruleClick(IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e)
@@ -619,6 +791,16 @@ namespace winrt::ModernLife::implementation
         dropdownRules().Content(winrt::box_value(item.Text()));
 
         _ruleset = static_cast<BoardRules>(item.Tag().as<int>());
+        _rule = Rule::Preset(_ruleset);
+        _simulation.Rules(_ruleset);
+    }
+
+    void MainWindow::topologyClick(IInspectable const& sender, [[maybe_unused]] winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e)
+    {
+        Microsoft::UI::Xaml::Controls::MenuFlyoutItem item = sender.as<Microsoft::UI::Xaml::Controls::MenuFlyoutItem>();
+        dropdownTopology().Content(winrt::box_value(item.Text()));
+
+        _simulation.Post([topology = static_cast<Topology>(item.Tag().as<int>())](Board& board) { board.SetTopology(topology); });
     }
 
     void MainWindow::SetMyTitleBar()
@@ -673,6 +855,7 @@ namespace winrt::ModernLife::implementation
     {
         ML_METHOD;
         //timer.Revoke();
+        _simulation.Stop();
         Util::Log::Shutdown();
         //PropertyChangedRevoker();
     }
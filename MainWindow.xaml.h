@@ -17,6 +17,8 @@
 
 #include "Renderer.h"
 #include "Board.h"
+#include "Simulation.h"
+#include "FrameGovernor.h"
 #include "fpscounter.h"
 #include "TimerHelper.h"
 
@@ -79,6 +81,7 @@ namespace winrt::ModernLife::implementation
         winrt::hstring LiveCount() const;
         winrt::hstring GenerationCount() const;
         winrt::hstring FPSAverage() const;
+        winrt::hstring GenerationRate() const;
         void BoardWidth(uint16_t value);
         uint16_t BoardWidth() const noexcept;
         uint16_t BoardHeight() const noexcept;
@@ -93,13 +96,17 @@ namespace winrt::ModernLife::implementation
         void speedClick(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
         void CanvasBoard_SizeChanged(IInspectable const& sender, winrt::Microsoft::UI::Xaml::SizeChangedEventArgs const& e);
         void GoButton_Click(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
+        void RewindButton_Click(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
         void RandomizeButton_Click(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
         winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> PickShapeFileAsync();
         winrt::fire_and_forget ShowMessageBox(const winrt::hstring& title, const winrt::hstring& message);
         winrt::fire_and_forget LoadShape_Click(winrt::Windows::Foundation::IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
+        winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> PickSaveFileAsync();
+        winrt::fire_and_forget SaveShape_Click(winrt::Windows::Foundation::IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
 
         void SetStatus(const std::string& message);
         void ruleClick(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
+        void topologyClick(IInspectable const& sender, winrt::Microsoft::UI::Xaml::RoutedEventArgs const& e);
         void CanvasBoard_CreateResources(Microsoft::Graphics::Canvas::UI::Xaml::CanvasControl const& sender, winrt::Microsoft::Graphics::Canvas::UI::CanvasCreateResourcesEventArgs const& args);
         void OnRandomizeBoard();
         HWND GetWindowHandle() const;
@@ -111,14 +118,21 @@ namespace winrt::ModernLife::implementation
         void RandomizeBoard();
         void OnMaxAgeChanged();
         void OnFirstRun();
+        void ApplyGovernor();
 
     private:
         Microsoft::Graphics::Canvas::CanvasDevice _canvasDevice{ nullptr };
 
         Renderer _renderer;
         Board _board;
+        // owns the board once it's started, everything that changes the board goes through it
+        Simulation _simulation{ _board };
         FPScounter fps{};
-        TimerHelper timer{ 30, true };
+        // draws the newest snapshot at the display rate, the simulation keeps its own rate
+        static constexpr int DisplayFPS{ 60 };
+        TimerHelper timer{ DisplayFPS, true };
+        // trades generations per frame and render detail to keep frames inside the timer interval
+        FrameGovernor _governor;
 
         float _dpi{ 0.0f };
 
@@ -126,9 +140,17 @@ namespace winrt::ModernLife::implementation
         uint16_t _randompercent{30};
         uint16_t _maxage{ 1000 };
         BoardRules _ruleset{ BoardRules::FastConway };
+        // the rule the board runs, a preset or one a pattern asked for, saved with the board
+        Rule _rule{ Rule::Preset(BoardRules::FastConway) };
         uint16_t _boardwidth{ 300 };
         uint16_t _boardheight{ 300 };
         PointerMode _PointerMode = PointerMode::None;
+        CycleInfo _reportedCycle;
+        // what the last frame drew, for the counters
+        uint32_t _shownGeneration{ 0 };
+        uint32_t _shownLiveCount{ 0 };
+        // how much memory the Back button's history can use
+        static constexpr size_t RewindMemoryCap{ size_t{ 256 } << 20 };
 
         winrt::event_token _propertyToken;
         winrt::event<Microsoft::UI::Xaml::Data::PropertyChangedEventHandler> _propertyChanged;
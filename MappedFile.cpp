@@ -0,0 +1,140 @@
+#include "pch.h"
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <gsl/gsl>
+
+#include "Log.h"
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		ML_TRACE("Failed to open file: {}", path.string());
+		return false;
+	}
+	_file = file;
+
+	LARGE_INTEGER size{};
+	if (!::GetFileSizeEx(file, &size))
+	{
+		Close();
+		return false;
+	}
+
+	// an empty file can't be mapped, and has nothing to map
+	_open = true;
+	if (size.QuadPart == 0)
+	{
+		return true;
+	}
+
+	_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping != nullptr)
+	{
+		_data = static_cast<const char*>(::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (_data == nullptr)
+	{
+		ML_TRACE("Failed to map file: {}", path.string());
+		Close();
+		return false;
+	}
+	_size = gsl::narrow_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() noexcept
+{
+	if (_data != nullptr)
+	{
+		::UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr)
+	{
+		::CloseHandle(_mapping);
+	}
+	if (_file != nullptr)
+	{
+		::CloseHandle(_file);
+	}
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = nullptr;
+	_open = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	_file = ::open(path.c_str(), O_RDONLY);
+	if (_file < 0)
+	{
+		ML_TRACE("Failed to open file: {}", path.string());
+		return false;
+	}
+
+	struct stat status{};
+	if (::fstat(_file, &status) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	// an empty file can't be mapped, and has nothing to map
+	_open = true;
+	if (status.st_size == 0)
+	{
+		return true;
+	}
+
+	void* data = ::mmap(nullptr, gsl::narrow_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		ML_TRACE("Failed to map file: {}", path.string());
+		Close();
+		return false;
+	}
+
+	// the parsers read front to back
+	::madvise(data, gsl::narrow_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(data);
+	_size = gsl::narrow_cast<size_t>(status.st_size);
+	return true;
+}
+
+void MappedFile::Close() noexcept
+{
+	if (_data != nullptr)
+	{
+		::munmap(const_cast<char*>(_data), _size);
+	}
+	if (_file >= 0)
+	{
+		::close(_file);
+	}
+	_data = nullptr;
+	_size = 0;
+	_file = -1;
+	_open = false;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// a file mapped read-only into memory, so a parser can walk all of it without copying it into buffers first
+// the OS reads the pages in as the parser gets to them, and drops them again when memory is short
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path)
+    {
+        Open(path);
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    // copy/move not needed
+    MappedFile(MappedFile&&) = delete;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file can't be opened or mapped, an empty file opens with no text
+    bool Open(const std::filesystem::path& path);
+    void Close() noexcept;
+
+    [[nodiscard]] bool IsOpen() const noexcept
+    {
+        return _open;
+    }
+
+    // the whole file, valid until Close
+    [[nodiscard]] std::string_view Text() const noexcept
+    {
+        return { _data, _size };
+    }
+
+private:
+    const char* _data{ nullptr };
+    size_t _size{ 0 };
+    bool _open{ false };
+
+#ifdef _WIN32
+    void* _file{ nullptr };
+    void* _mapping{ nullptr };
+#else
+    int _file{ -1 };
+#endif
+};
@@ -0,0 +1,262 @@
+#include "pch.h"
+
+#include "NeighborKernel.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define ML_KERNEL_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets us use AVX2 intrinsics in any function, gcc and clang need to be told per function
+#if defined(ML_KERNEL_X64) && !defined(_MSC_VER)
+#define ML_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ML_TARGET_AVX2
+#endif
+
+namespace
+{
+	// the first and last cells in a row wrap around, so they're done one at a time
+	inline uint8_t CountWrapped(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t x, uint16_t width) noexcept
+	{
+		const uint16_t left = (x == 0) ? width - 1 : x - 1;
+		const uint16_t right = (x == width - 1) ? 0 : x + 1;
+
+		return above[left] + above[x] + above[right]
+			+ row[left] + row[right]
+			+ below[left] + below[x] + below[right];
+	}
+
+	// counts the wrapped edge cells in [start, end) one at a time and hands the interior to CountInterior
+	template <typename Interior>
+	inline void CountSpanWith(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width, uint16_t start, uint16_t end, Interior&& CountInterior) noexcept
+	{
+		if (width < 3)
+		{
+			for (uint16_t x = start; x < end; x++)
+			{
+				counts[x] = CountWrapped(above, row, below, x, width);
+			}
+			return;
+		}
+
+		if (start == 0)
+		{
+			counts[0] = CountWrapped(above, row, below, 0, width);
+			start = 1;
+		}
+
+		if (end == width)
+		{
+			counts[width - 1] = CountWrapped(above, row, below, width - 1, width);
+			end = width - 1;
+		}
+
+		if (start < end)
+		{
+			CountInterior(start, end);
+		}
+	}
+
+	// interior cells [start, end) have all their neighbors in the row, no wrapping needed
+	inline void CountInteriorScalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t start, uint16_t end) noexcept
+	{
+		for (uint16_t x = start; x < end; x++)
+		{
+			counts[x] = above[x - 1] + above[x] + above[x + 1]
+				+ row[x - 1] + row[x + 1]
+				+ below[x - 1] + below[x] + below[x + 1];
+		}
+	}
+
+	void CountSpanScalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width, uint16_t start, uint16_t end) noexcept
+	{
+		CountSpanWith(above, row, below, counts, width, start, end, [=](uint16_t first, uint16_t last) noexcept
+			{
+				CountInteriorScalar(above, row, below, counts, first, last);
+			});
+	}
+
+	inline void NextAliveScalar(const uint8_t* alive, const uint8_t* counts, uint8_t* next, uint16_t start, uint16_t end, const uint8_t* table) noexcept
+	{
+		for (uint16_t x = start; x < end; x++)
+		{
+			next[x] = table[alive[x] * 9 + counts[x]];
+		}
+	}
+
+#ifdef ML_KERNEL_X64
+	// sums the 8 neighbors of the 16 cells starting at x, loading each row at x - 1, x and x + 1
+	// cells are 0 or 1, so the sum never overflows a byte
+	inline __m128i Sum16(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t x) noexcept
+	{
+		const auto load = [](const uint8_t* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+
+		__m128i sum = _mm_add_epi8(load(above + x - 1), load(above + x));
+		sum = _mm_add_epi8(sum, load(above + x + 1));
+		sum = _mm_add_epi8(sum, load(row + x - 1));
+		sum = _mm_add_epi8(sum, load(row + x + 1));
+		sum = _mm_add_epi8(sum, load(below + x - 1));
+		sum = _mm_add_epi8(sum, load(below + x));
+		return _mm_add_epi8(sum, load(below + x + 1));
+	}
+
+	// same as Sum16 for 32 cells
+	ML_TARGET_AVX2 inline __m256i Sum32(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint16_t x) noexcept
+	{
+		__m256i sum = _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x - 1)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x)));
+		sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x + 1)));
+		sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x - 1)));
+		sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 1)));
+		sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + x - 1)));
+		sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + x)));
+		return _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + x + 1)));
+	}
+
+	void CountInteriorSSE2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t start, uint16_t end) noexcept
+	{
+		uint16_t x = start;
+		for (; x + 16 <= end; x += 16)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(counts + x), Sum16(above, row, below, x));
+		}
+
+		CountInteriorScalar(above, row, below, counts, x, end);
+	}
+
+	ML_TARGET_AVX2 void CountInteriorAVX2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t start, uint16_t end) noexcept
+	{
+		uint16_t x = start;
+		for (; x + 32 <= end; x += 32)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(counts + x), Sum32(above, row, below, x));
+		}
+
+		// the tail is SSE2 code, which runs slowly while the upper halves of the ymm registers are dirty,
+		// and gcc doesn't clear them before a tail call
+		_mm256_zeroupper();
+
+		// finish the tail 16 at a time, then one at a time
+		CountInteriorSSE2(above, row, below, counts, x, end);
+	}
+
+	// the counts pick from the dead and live halves of the table with a byte shuffle, and the alive byte picks the half
+	ML_TARGET_AVX2 void NextAliveAVX2(const uint8_t* alive, const uint8_t* counts, uint8_t* next, uint16_t start, uint16_t end, const uint8_t* table) noexcept
+	{
+		const __m256i dead = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+		const __m256i live = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table + 9)));
+		const __m256i zero = _mm256_setzero_si256();
+
+		uint16_t x = start;
+		for (; x + 32 <= end; x += 32)
+		{
+			const __m256i count = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + x));
+			const __m256i isAlive = _mm256_sub_epi8(zero, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(alive + x)));
+			const __m256i result = _mm256_blendv_epi8(_mm256_shuffle_epi8(dead, count), _mm256_shuffle_epi8(live, count), isAlive);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(next + x), result);
+		}
+
+		_mm256_zeroupper();
+		NextAliveScalar(alive, counts, next, x, end, table);
+	}
+
+	void CountSpanSSE2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width, uint16_t start, uint16_t end) noexcept
+	{
+		CountSpanWith(above, row, below, counts, width, start, end, [=](uint16_t first, uint16_t last) noexcept
+			{
+				CountInteriorSSE2(above, row, below, counts, first, last);
+			});
+	}
+
+	void CountSpanAVX2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width, uint16_t start, uint16_t end) noexcept
+	{
+		CountSpanWith(above, row, below, counts, width, start, end, [=](uint16_t first, uint16_t last) noexcept
+			{
+				CountInteriorAVX2(above, row, below, counts, first, last);
+			});
+	}
+
+	bool CpuHasAVX2() noexcept
+	{
+#ifdef _MSC_VER
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		// the OS has to save the YMM registers too (OSXSAVE and XCR0 bits 1 and 2)
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+}
+
+NeighborKernel::NeighborKernel() noexcept
+{
+	Select(BestPath());
+}
+
+NeighborKernel::NeighborKernel(Path path) noexcept
+{
+	Select(path);
+}
+
+NeighborKernel::Path NeighborKernel::BestPath() noexcept
+{
+#ifdef ML_KERNEL_X64
+	static const Path best = CpuHasAVX2() ? Path::AVX2 : Path::SSE2;
+	return best;
+#else
+	return Path::Scalar;
+#endif
+}
+
+const char* NeighborKernel::PathName(Path path) noexcept
+{
+	switch (path)
+	{
+		case Path::Scalar: return "Scalar";
+		case Path::SSE2: return "SSE2";
+		case Path::AVX2: return "AVX2";
+		default: return "?";
+	}
+}
+
+void NeighborKernel::Select(Path path) noexcept
+{
+#ifdef ML_KERNEL_X64
+	// every x64 CPU has SSE2
+	if (path == Path::AVX2 && BestPath() != Path::AVX2)
+	{
+		path = Path::SSE2;
+	}
+
+	switch (path)
+	{
+		case Path::AVX2: _countSpan = &CountSpanAVX2; _countPadded = &CountInteriorAVX2; _nextAlive = &NextAliveAVX2; break;
+		case Path::SSE2: _countSpan = &CountSpanSSE2; _countPadded = &CountInteriorSSE2; _nextAlive = &NextAliveScalar; break;
+		default: _countSpan = &CountSpanScalar; _countPadded = &CountInteriorScalar; _nextAlive = &NextAliveScalar; break;
+	}
+#else
+	path = Path::Scalar;
+	_countSpan = &CountSpanScalar;
+	_countPadded = &CountInteriorScalar;
+	_nextAlive = &NextAliveScalar;
+#endif
+	_path = path;
+}
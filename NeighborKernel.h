@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts live neighbors for a row of a byte-per-cell board (one byte per cell, 0 or 1)
+// from the row above, the row itself and the row below. The row wraps like the torus in Board,
+// but the wrap is only computed for the first and last cell; everything in between is vectorized.
+// CountSpan counts part of a row, e.g. one tile, and writes counts at the same x as the cells.
+// CountPaddedSpan is for rows with a halo cell on each side (x = -1 and x = width) that the caller has filled,
+// so every cell is an interior cell and nothing wraps.
+// NextAliveSpan applies a rule's alive table to a span of counts, also vectorized on the AVX2 path.
+class NeighborKernel
+{
+public:
+    enum class Path : uint8_t { Scalar, SSE2, AVX2 };
+
+    // picks the fastest path the CPU supports, once
+    NeighborKernel() noexcept;
+
+    // force a specific path, e.g. to compare them; falls back to Scalar if the CPU can't run it
+    explicit NeighborKernel(Path path) noexcept;
+
+    void CountRow(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width) const noexcept
+    {
+        _countSpan(above, row, below, counts, width, 0, width);
+    }
+
+    // counts cells [start, end) of the row
+    void CountSpan(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t width, uint16_t start, uint16_t end) const noexcept
+    {
+        _countSpan(above, row, below, counts, width, start, end);
+    }
+
+    // counts cells [start, end) of a row whose neighbors at -1 and end are readable
+    void CountPaddedSpan(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* counts, uint16_t start, uint16_t end) const noexcept
+    {
+        _countPadded(above, row, below, counts, start, end);
+    }
+
+    // next[x] for cells [start, end) from their alive byte and neighbor count, with the table from Rule::AliveTable
+    void NextAliveSpan(const uint8_t* alive, const uint8_t* counts, uint8_t* next, uint16_t start, uint16_t end, const uint8_t* table) const noexcept
+    {
+        _nextAlive(alive, counts, next, start, end, table);
+    }
+
+    [[nodiscard]] Path GetPath() const noexcept
+    {
+        return _path;
+    }
+
+    [[nodiscard]] static Path BestPath() noexcept;
+    [[nodiscard]] static const char* PathName(Path path) noexcept;
+
+private:
+    using CountSpanFunc = void (*)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, uint16_t, uint16_t, uint16_t) noexcept;
+    using CountPaddedFunc = void (*)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, uint16_t, uint16_t) noexcept;
+    using NextAliveFunc = void (*)(const uint8_t*, const uint8_t*, uint8_t*, uint16_t, uint16_t, const uint8_t*) noexcept;
+
+    void Select(Path path) noexcept;
+
+    Path _path{ Path::Scalar };
+    CountSpanFunc _countSpan{ nullptr };
+    CountPaddedFunc _countPadded{ nullptr };
+    NextAliveFunc _nextAlive{ nullptr };
+};
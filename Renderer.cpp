@@ -89,7 +89,7 @@ void Renderer::SetupRenderTargets()
 }
 
 // How Render works
-// 1.   Calls RenderOffScreen, the only method that needs the board
+// 1.   Calls RenderOffScreen, the only method that needs the board snapshot
 //      Which splits the board into horizontal slices, and creates a CanvasDrawingSession for each backbuffer slice
 //      that was created by SetupRenderTargets. It then creates a thread per slice and each thread is constructed with
 //      DrawHorizontalRows to draw the correct rows into the correct slice
@@ -97,12 +97,39 @@ void Renderer::SetupRenderTargets()
 //      by drawing the correct sprite from the spritesheet
 // 3.   When all the threads created by RenderOffScreen join (which they do automatically) control
 //      is returned to Render, which then draws each backbuffer slice into the front buffer
+// At RenderDetail::Flat, RenderFlat and CompositeFlat take the place of both, the governor in MainWindow picks the detail
  
-void Renderer::Render(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const Board& board)
+void Renderer::Render(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const BoardSnapshot& snapshot)
 {
     ML_METHOD;
-    RenderOffscreen(board);
+    const auto start = std::chrono::steady_clock::now();
 
+    // right after a resize the newest snapshot can still be the old size, so the last frame is shown again until it catches up
+    const bool current = snapshot.width == _boardwidth && snapshot.height == _boardheight;
+    if (_detail == RenderDetail::Flat)
+    {
+        if (current)
+        {
+            RenderFlat(snapshot);
+        }
+        const auto rendered = std::chrono::steady_clock::now();
+        CompositeFlat(ds);
+        _times = { rendered - start, std::chrono::steady_clock::now() - rendered };
+        return;
+    }
+
+    if (current)
+    {
+        RenderOffscreen(snapshot);
+    }
+    const auto rendered = std::chrono::steady_clock::now();
+    Composite(ds);
+    _times = { rendered - start, std::chrono::steady_clock::now() - rendered };
+}
+
+// This copies the backbuffer slices to the canvas
+void Renderer::Composite(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds)
+{
     if (_threadcount == 1)
     {
         {
@@ -150,8 +177,37 @@ void Renderer::Render(const Microsoft::Graphics::Canvas::CanvasDrawingSession& d
     ds.Close();
 }
 
-// This renders the board to the backbuffers
-void Renderer::RenderOffscreen(const Board& board)
+// The Flat detail level colors one pixel per cell instead of drawing a sprite per cell,
+// so it costs a pass over the snapshot and one stretched bitmap instead of a sprite batch that grows with the board
+void Renderer::RenderFlat(const BoardSnapshot& snapshot)
+{
+    ML_METHOD;
+
+    const uint16_t oldest = gsl::narrow_cast<uint16_t>(_flatColors.size() - 1);
+    _flatPixels.resize(snapshot.sprites.size());
+    for (size_t i = 0; i < snapshot.sprites.size(); i++)
+    {
+        const uint16_t sprite = snapshot.sprites[i];
+        _flatPixels[i] = (sprite == BoardSnapshot::NotDrawn) ? Windows::UI::Colors::WhiteSmoke() : _flatColors[std::min(sprite, oldest)];
+    }
+    _flatBitmap = Microsoft::Graphics::Canvas::CanvasBitmap::CreateFromColors(_canvasDevice, _flatPixels, snapshot.width, snapshot.height);
+}
+
+void Renderer::CompositeFlat(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds)
+{
+    ds.Clear(Windows::UI::Colors::WhiteSmoke());
+    if (_flatBitmap != nullptr)
+    {
+        const Windows::Foundation::Rect destRect{ 0.0f, 0.0f, _bestcanvassize, _bestcanvassize };
+        ds.Antialiasing(Microsoft::Graphics::Canvas::CanvasAntialiasing::Aliased);
+        ds.DrawImage(_flatBitmap, destRect, _flatBitmap.Bounds(), 1.0f, Microsoft::Graphics::Canvas::CanvasImageInterpolation::NearestNeighbor);
+    }
+    ds.Flush();
+    ds.Close();
+}
+
+// This renders the board snapshot to the backbuffers
+void Renderer::RenderOffscreen(const BoardSnapshot& snapshot)
 {
     ML_METHOD;
 
@@ -160,7 +216,7 @@ void Renderer::RenderOffscreen(const Board& board)
     if (_threadcount == 1)
     {
         Microsoft::Graphics::Canvas::CanvasDrawingSession dsSingle = _backbuffersingle.CreateDrawingSession();
-        DrawHorizontalRows(dsSingle, board, 0, _boardheight);
+        DrawHorizontalRows(dsSingle, snapshot, 0, _boardheight);
         return;
     }
 
@@ -171,8 +227,7 @@ void Renderer::RenderOffscreen(const Board& board)
         _dsList.push_back({ _backbuffers.at(j).CreateDrawingSession() });
     }
 
-    // technically the board could be changing underneath us, but we're only reading the cells not writing to them
-    // TODO may need to lock the board here eg std::scoped_lock lock{ _board.GetLock() };
+    // the snapshot belongs to the UI thread until the next one is taken, so the board can go on to the next generation while it's drawn
     uint16_t startRow = 0;
     std::vector<std::jthread> threads;
     int t = 0;
@@ -180,17 +235,17 @@ void Renderer::RenderOffscreen(const Board& board)
     {
         //ML_TRACE("RenderOffscreen Start Row: {} EndRow: {}", startRow, startRow + _rowsPerSlice);
 
-        threads.emplace_back(std::jthread{ &Renderer::DrawHorizontalRows, this, _dsList.at(t), std::ref(board), startRow, gsl::narrow_cast<uint16_t>(startRow + _rowsPerSlice) });
+        threads.emplace_back(std::jthread{ &Renderer::DrawHorizontalRows, this, _dsList.at(t), std::cref(snapshot), startRow, gsl::narrow_cast<uint16_t>(startRow + _rowsPerSlice) });
         startRow += _rowsPerSlice;
     }
 
-    //ML_TRACE("RenderOffscreen Start Row: {} EndRow: {}", startRow, board.Height());
-    threads.emplace_back(std::jthread{ &Renderer::DrawHorizontalRows, this, _dsList.at(t), std::ref(board), startRow, board.Height() });
+    //ML_TRACE("RenderOffscreen Start Row: {} EndRow: {}", startRow, snapshot.height);
+    threads.emplace_back(std::jthread{ &Renderer::DrawHorizontalRows, this, _dsList.at(t), std::cref(snapshot), startRow, snapshot.height });
 }
 
-void Renderer::DrawHorizontalRows(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const Board& board, uint16_t startRow, uint16_t endRow) const
+void Renderer::DrawHorizontalRows(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const BoardSnapshot& snapshot, uint16_t startRow, uint16_t endRow) const
 {
-    // only read from the board/the cells in this method
+    // only read from the snapshot in this method
     ds.Clear(Windows::UI::Colors::WhiteSmoke());
 #if 0// #ifdef _DEBUG
     // this makes the background of each backbuffer slice a band so you can see them
@@ -205,16 +260,15 @@ void Renderer::DrawHorizontalRows(const Microsoft::Graphics::Canvas::CanvasDrawi
     {
         for (uint16_t y = startRow; y < endRow; y++)
         {
-            for (uint16_t x = 0; x < board.Width(); x++)
+            const uint16_t* sprites = &snapshot.sprites[gsl::narrow_cast<size_t>(y) * snapshot.width];
+            for (uint16_t x = 0; x < snapshot.width; x++)
             {
-                const Cell& cell = board.GetCell(x, y);
-
                 rectDest.X = gsl::narrow_cast<float>(x) * _dipsPerCellDimension;
                 rectDest.Y = gsl::narrow_cast<float>(y - startRow) * _dipsPerCellDimension;
-                if (cell.ShouldDraw())
+                if (sprites[x] != BoardSnapshot::NotDrawn)
                 {
                     // this is where all the time goes:
-                    spriteBatch.DrawFromSpriteSheet(_spritesheet, rectDest, GetSpriteCell(cell.Age()));
+                    spriteBatch.DrawFromSpriteSheet(_spritesheet, rectDest, GetSpriteCell(sprites[x]));
                 }
             }
         }
@@ -289,6 +343,13 @@ void Renderer::BuildSpriteSheet()
         ds.Flush();
         ds.Close();
     }
+
+    // the same colors, one per sprite, for the Flat detail level
+    _flatColors.resize(gsl::narrow_cast<size_t>(_spriteMaxIndex) + 2);
+    for (uint16_t i = 0; i < _flatColors.size(); i++)
+    {
+        _flatColors[i] = GetCellColorHSV(i);
+    }
 }
 
 void Renderer::Size(uint16_t width, uint16_t height)
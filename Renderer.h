@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <mutex>
 
 #include <winrt/Windows.Foundation.h>
@@ -11,6 +12,21 @@
 
 using namespace winrt;
 
+// how the board is drawn, from the most detail to the cheapest
+// Sprites draws every cell from the sprite sheet, Flat draws each cell as one pixel of a bitmap the GPU stretches over the canvas
+enum class RenderDetail : uint8_t
+{
+	Sprites,
+	Flat
+};
+
+// time spent in the last Render, drawing the board offscreen and copying it to the canvas
+struct RenderTimes
+{
+	std::chrono::nanoseconds offscreen{ 0 };
+	std::chrono::nanoseconds composite{ 0 };
+};
+
 class Renderer
 {
 public:
@@ -31,12 +47,29 @@ public:
 	void Size(uint16_t width, uint16_t height);
 	void Device(const Microsoft::Graphics::Canvas::CanvasDevice& device);
 
+	static constexpr uint8_t DetailLevels{ 2 };
+
+	void Detail(RenderDetail detail) noexcept
+	{
+		_detail = detail;
+	}
+
+	[[nodiscard]] RenderDetail Detail() const noexcept
+	{
+		return _detail;
+	}
+
 	void FindBestCanvasSize(size_t windowHeight);
 	void WindowResize();
 
 	GridPoint GetCellAtPoint(Windows::Foundation::Point point) noexcept;
 
-	void Render(Microsoft::Graphics::Canvas::CanvasDrawingSession const& ds, const Board& board);
+	void Render(Microsoft::Graphics::Canvas::CanvasDrawingSession const& ds, const BoardSnapshot& snapshot);
+
+	[[nodiscard]] const RenderTimes& LastRenderTimes() const noexcept
+	{
+		return _times;
+	}
 
 	[[nodiscard]] float DipsPerCell() noexcept
 	{
@@ -77,8 +110,11 @@ private:
 	Windows::Foundation::Rect GetSpriteCell(uint16_t index) const noexcept;
 	void SetupRenderTargets();
 	void BuildSpriteSheet();
-	void DrawHorizontalRows(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const Board& board, uint16_t startRow, uint16_t endRow) const;
-	void RenderOffscreen(const Board& board);
+	void DrawHorizontalRows(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds, const BoardSnapshot& snapshot, uint16_t startRow, uint16_t endRow) const;
+	void RenderOffscreen(const BoardSnapshot& snapshot);
+	void Composite(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds);
+	void RenderFlat(const BoardSnapshot& snapshot);
+	void CompositeFlat(const Microsoft::Graphics::Canvas::CanvasDrawingSession& ds);
 	Windows::UI::Color GetCellColorHSV(uint16_t age) const;
 	Windows::UI::Color GetOutlineColorHSV(uint16_t age) const;
 
@@ -92,6 +128,14 @@ private:
 	Microsoft::Graphics::Canvas::CanvasRenderTarget _spritesheet{ nullptr };
 	Microsoft::Graphics::Canvas::CanvasDevice _canvasDevice{ nullptr };
 
+	// the Flat detail level: a color per sprite index, and the board one pixel per cell
+	std::vector<Windows::UI::Color> _flatColors;
+	std::vector<Windows::UI::Color> _flatPixels;
+	Microsoft::Graphics::Canvas::CanvasBitmap _flatBitmap{ nullptr };
+
+	RenderDetail _detail{ RenderDetail::Sprites };
+	RenderTimes _times;
+
 	int _threadcount{ 0 };
 	unsigned int _pxPerCellDimension{ 0 };
 	float _dpi{ 0.0f };
@@ -0,0 +1,219 @@
+#include "pch.h"
+
+#include "Rule.h"
+
+#include <gsl/gsl>
+
+namespace
+{
+	constexpr uint16_t Neighbors(std::initializer_list<int> counts) noexcept
+	{
+		uint16_t mask = 0;
+		for (const int n : counts)
+		{
+			mask |= gsl::narrow_cast<uint16_t>(1 << n);
+		}
+		return mask;
+	}
+}
+
+Rule::Rule() noexcept
+	: Rule(Neighbors({ 3 }), Neighbors({ 2, 3 }))
+{
+}
+
+Rule::Rule(uint16_t birth, uint16_t survival, uint16_t states) noexcept
+	: _birth(birth & 0x1FF), _survival(survival & 0x1FF), _states(std::clamp(states, uint16_t{ 2 }, MaxStates))
+{
+	Compile();
+}
+
+void Rule::Compile() noexcept
+{
+	for (uint8_t n = 0; n <= 8; n++)
+	{
+		// dead cells
+		_table[n] = ((_birth >> n) & 1) ? Cell::State::Born : Cell::State::Dead;
+
+		// live cells
+		_table[9 + n] = ((_survival >> n) & 1) ? Cell::State::Live : Cell::State::Dying;
+	}
+
+	for (size_t i = 0; i < _table.size(); i++)
+	{
+		_aliveTable[i] = (_table[i] == Cell::State::Born || _table[i] == Cell::State::Live) ? 1 : 0;
+	}
+}
+
+bool Rule::Parse(std::string_view text, Rule& rule)
+{
+	uint16_t birth = 0;
+	uint16_t survival = 0;
+	int states = 2;
+
+	const auto addNeighbors = [](uint16_t& mask, char c) noexcept
+	{
+		if (c < '0' || c > '8')
+		{
+			return false;
+		}
+		mask |= gsl::narrow_cast<uint16_t>(1 << (c - '0'));
+		return true;
+	};
+
+	const auto addDigit = [](int& number, char c) noexcept
+	{
+		if (c < '0' || c > '9' || number > Rule::MaxStates)
+		{
+			return false;
+		}
+		number = number * 10 + (c - '0');
+		return true;
+	};
+
+	const bool lettered = text.find_first_of("BbSs") != std::string_view::npos;
+	if (lettered)
+	{
+		enum class Part { None, Birth, Survival, States };
+		Part part = Part::None;
+		for (const char c : text)
+		{
+			if (c == 'B' || c == 'b')
+			{
+				part = Part::Birth;
+			}
+			else if (c == 'S' || c == 's')
+			{
+				part = Part::Survival;
+			}
+			else if (c == 'C' || c == 'c' || c == 'G' || c == 'g')
+			{
+				part = Part::States;
+				states = 0;
+			}
+			else if (c == '/' || c == ' ')
+			{
+				continue;
+			}
+			else if (part == Part::Birth)
+			{
+				if (!addNeighbors(birth, c))
+				{
+					return false;
+				}
+			}
+			else if (part == Part::Survival)
+			{
+				if (!addNeighbors(survival, c))
+				{
+					return false;
+				}
+			}
+			else if (part != Part::States || !addDigit(states, c))
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		// survival/birth or survival/birth/states, e.g. 23/3 or /2/3
+		int part = 0;
+		for (const char c : text)
+		{
+			if (c == '/')
+			{
+				part++;
+				if (part == 2)
+				{
+					states = 0;
+				}
+			}
+			else if (c == ' ')
+			{
+				continue;
+			}
+			else if (part == 0 && !addNeighbors(survival, c))
+			{
+				return false;
+			}
+			else if (part == 1 && !addNeighbors(birth, c))
+			{
+				return false;
+			}
+			else if (part == 2 && !addDigit(states, c))
+			{
+				return false;
+			}
+			else if (part > 2)
+			{
+				return false;
+			}
+		}
+
+		if (part == 0)
+		{
+			return false;
+		}
+	}
+
+	if (states < 2 || states > MaxStates)
+	{
+		return false;
+	}
+
+	rule = Rule(birth, survival, gsl::narrow_cast<uint16_t>(states));
+	return true;
+}
+
+Rule Rule::Preset(BoardRules rules) noexcept
+{
+	switch (rules)
+	{
+		// https://en.wikipedia.org/wiki/Day_and_Night_(cellular_automaton)
+		case BoardRules::DayAndNight: return Rule(Neighbors({ 3, 6, 7, 8 }), Neighbors({ 3, 4, 6, 7, 8 }));
+
+		// https://en.wikipedia.org/wiki/Life_without_Death
+		case BoardRules::LifeWithoutDeath: return Rule(Neighbors({ 3 }), Neighbors({ 0, 1, 2, 3, 4, 5, 6, 7, 8 }));
+
+		// https://en.wikipedia.org/wiki/Brian%27s_Brain
+		case BoardRules::BriansBrain: return Rule(Neighbors({ 2 }), 0, 3);
+
+		// https://en.wikipedia.org/wiki/Seeds_(cellular_automaton)
+		case BoardRules::Seeds: return Rule(Neighbors({ 2 }), 0);
+
+		// https://en.wikipedia.org/wiki/Highlife_(cellular_automaton)
+		case BoardRules::Highlife: return Rule(Neighbors({ 3, 6 }), Neighbors({ 2, 3 }));
+
+		case BoardRules::FastConway:
+		case BoardRules::Conway:
+		default: return Rule();
+	}
+}
+
+std::string Rule::ToString() const
+{
+	std::string text{ "B" };
+	for (int n = 0; n <= 8; n++)
+	{
+		if ((_birth >> n) & 1)
+		{
+			text += gsl::narrow_cast<char>('0' + n);
+		}
+	}
+
+	text += "/S";
+	for (int n = 0; n <= 8; n++)
+	{
+		if ((_survival >> n) & 1)
+		{
+			text += gsl::narrow_cast<char>('0' + n);
+		}
+	}
+
+	if (IsGenerations())
+	{
+		text += "/C" + std::to_string(_states);
+	}
+	return text;
+}
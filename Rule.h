@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Cell.h"
+
+enum class BoardRules : uint8_t
+{
+    FastConway = 1,
+    Conway,
+    DayAndNight,
+    LifeWithoutDeath,
+    BriansBrain,
+    Seeds,
+    Highlife
+};
+
+// a Life-like rule in B/S notation, e.g. B3/S23 is Conway's Life:
+// a dead cell with 3 live neighbors is born, a live cell with 2 or 3 survives, everything else dies
+// the rule is compiled into a table indexed by (alive * 9 + neighbors), so stepping a cell is one lookup
+//
+// Generations rules add a state count, B/S/C: a live cell that doesn't survive decays through
+// states 2 to C - 1 before it's dead, and only live cells count as neighbors
+// B2/S/C3 is Brian's Brain, C2 is the same as a plain B/S rule
+class Rule
+{
+public:
+    // Conway's B3/S23
+    Rule() noexcept;
+
+    // bit n of birth/survival is set if a cell with n live neighbors is born/survives
+    // states is 2 to MaxStates
+    Rule(uint16_t birth, uint16_t survival, uint16_t states = 2) noexcept;
+
+    static constexpr uint16_t MaxStates{ 256 };
+
+    // accepts B3/S23, b3/s23, B3S23, S23/B3 and the older survival/birth form 23/3
+    // and for Generations B2/S/C3, B2/S/G3 or survival/birth/states /2/3
+    // returns false and leaves rule alone if text isn't a rule
+    [[nodiscard]] static bool Parse(std::string_view text, Rule& rule);
+
+    // the rule for a built-in ruleset
+    [[nodiscard]] static Rule Preset(BoardRules rules) noexcept;
+
+    // the state the rules leave a cell in, the step turns Born into Live and Dying into Dead
+    // only for rules with 2 states
+    [[nodiscard]] Cell::State NextState(uint8_t alive, uint8_t neighbors) const noexcept
+    {
+        return _table[alive * 9 + neighbors];
+    }
+
+    // 1 if the cell is alive in the next generation, the same table with Born and Live as 1
+    [[nodiscard]] uint8_t NextAlive(uint8_t alive, uint8_t neighbors) const noexcept
+    {
+        return _aliveTable[alive * 9 + neighbors];
+    }
+
+    // the same table for NeighborKernel::NextAliveSpan, 9 entries for dead cells then 9 for live ones
+    [[nodiscard]] const uint8_t* AliveTable() const noexcept
+    {
+        return _aliveTable.data();
+    }
+
+    [[nodiscard]] uint16_t Birth() const noexcept
+    {
+        return _birth;
+    }
+
+    [[nodiscard]] uint16_t Survival() const noexcept
+    {
+        return _survival;
+    }
+
+    [[nodiscard]] uint16_t States() const noexcept
+    {
+        return _states;
+    }
+
+    [[nodiscard]] bool IsGenerations() const noexcept
+    {
+        return _states > 2;
+    }
+
+    // B3/S23 form, B2/S/C3 for Generations
+    [[nodiscard]] std::string ToString() const;
+
+    bool operator==(const Rule& other) const noexcept
+    {
+        return _birth == other._birth && _survival == other._survival && _states == other._states;
+    }
+
+private:
+    void Compile() noexcept;
+
+    uint16_t _birth{ 0 };
+    uint16_t _survival{ 0 };
+    uint16_t _states{ 2 };
+    std::array<Cell::State, 18> _table{};
+    // 18 entries, padded so 16 bytes can be read from either half
+    std::array<uint8_t, 32> _aliveTable{};
+};
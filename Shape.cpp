@@ -2,109 +2,747 @@
 
 #include "Shape.h"
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+#include <limits>
 #include <string>
+#include <string_view>
 
-#include <deps/gsl/include/gsl/gsl>
+#include <gsl/gsl>
 
 #include "Cell.h"
 #include "Log.h"
+#include "Macrocell.h"
+#include "MappedFile.h"
 
-bool Shape::Load()
+namespace
 {
-	ML_METHOD;
+	// how much of the file is read at a time
+	constexpr size_t BlockSize{ size_t{ 1 } << 16 };
 
-	_stream = std::ifstream(_path, std::ifstream::in);
+	// comment and header lines are the only text kept, a line past this is cut short
+	constexpr size_t MaxLineLength{ 4096 };
 
-    if (!_stream.is_open())
-    {
-		ML_TRACE("Failed to open file: {}", _path.string());
+	constexpr uint32_t MaxSide{ std::numeric_limits<uint16_t>::max() };
+
+	[[nodiscard]] std::string_view Trim(std::string_view text) noexcept
+	{
+		const size_t first = text.find_first_not_of(" \t");
+		if (first == std::string_view::npos)
+		{
+			return {};
+		}
+		return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+	}
+
+	[[nodiscard]] bool IsDigit(char c) noexcept
+	{
+		return c >= '0' && c <= '9';
+	}
+}
+
+// decodes a pattern one character at a time as the blocks come in, so a line can end in one block and carry on in the next
+// what it keeps between characters is the position, the run count or the number being read, and the current comment or header line
+class ShapeParser
+{
+public:
+	explicit ShapeParser(Shape& shape) noexcept : _shape(shape)
+	{
+	}
+
+	// false as soon as the text can't be a pattern
+	bool Feed(const char* data, size_t size);
+	bool Finish();
+
+private:
+	enum class Mode : uint8_t
+	{
+		LineStart,
+		Text,
+		PlainRow,
+		RleBody,
+		Coordinates,
+		Done
+	};
+
+	bool LineStart(char c);
+	bool TextLine();
+	bool RleHeader(std::string_view header);
+	bool RleBody(char c) noexcept;
+	bool Coordinate(char c);
+	void EndPlainRow() noexcept;
+
+	Shape& _shape;
+	Mode _mode{ Mode::LineStart };
+	std::string _text;
+
+	// RLE: where the next run goes and how long it is, 0 until a count is read
+	uint32_t _x{ 0 };
+	uint32_t _y{ 0 };
+	uint32_t _run{ 0 };
+	bool _headerSeen{ false };
+	bool _statePrefix{ false };
+
+	// plaintext and Life 1.06 collect the live cells and the extent, then size the shape once they've seen them all
+	std::vector<int32_t> _points;
+	int64_t _minX{ std::numeric_limits<int32_t>::max() };
+	int64_t _minY{ std::numeric_limits<int32_t>::max() };
+	int64_t _maxX{ std::numeric_limits<int32_t>::min() };
+	int64_t _maxY{ std::numeric_limits<int32_t>::min() };
+
+	// Life 1.06: the number being read and the ones read so far on this line
+	int64_t _number{ 0 };
+	bool _negative{ false };
+	bool _inNumber{ false };
+	int _fields{ 0 };
+	std::array<int64_t, 2> _coordinates{};
+};
+
+bool ShapeParser::Feed(const char* data, size_t size)
+{
+	for (const char c : std::string_view{ data, size })
+	{
+		switch (_mode)
+		{
+		case Mode::LineStart:
+			if (!LineStart(c))
+			{
+				return false;
+			}
+			break;
+
+		case Mode::Text:
+			if (c == '\n')
+			{
+				_mode = Mode::LineStart;
+				if (!TextLine())
+				{
+					return false;
+				}
+			}
+			else if (c != '\r' && _text.size() < MaxLineLength)
+			{
+				_text.push_back(c);
+			}
+			break;
+
+		case Mode::PlainRow:
+			if (c == '\n')
+			{
+				EndPlainRow();
+			}
+			else if (c != '\r')
+			{
+				// anything but O or * is dead, the way the .cells loader always read it
+				if (c == 'O' || c == '*')
+				{
+					_points.push_back(gsl::narrow_cast<int32_t>(_x));
+					_points.push_back(gsl::narrow_cast<int32_t>(_y));
+				}
+				if (++_x > MaxSide)
+				{
+					return false;
+				}
+			}
+			break;
+
+		case Mode::RleBody:
+			if (!RleBody(c))
+			{
+				return false;
+			}
+			break;
+
+		case Mode::Coordinates:
+			if (!Coordinate(c))
+			{
+				return false;
+			}
+			break;
+
+		case Mode::Done:
+			return true;
+		}
+	}
+	return true;
+}
+
+bool ShapeParser::LineStart(char c)
+{
+	if (c == '\n' || c == '\r' || c == ' ' || c == '\t')
+	{
+		return true;
+	}
+
+	// comments, and the RLE header
+	if (c == '#' || c == '!' || (c == 'x' && !_headerSeen && (_shape._format == Shape::Format::Unknown || _shape._format == Shape::Format::RLE)))
+	{
+		_mode = Mode::Text;
+		_text.assign(1, c);
+		return true;
+	}
+
+	if (_shape._format == Shape::Format::Unknown)
+	{
+		if (c != '.' && c != 'O' && c != '*')
+		{
+			return false;
+		}
+		_shape._format = Shape::Format::Plaintext;
+	}
+
+	switch (_shape._format)
+	{
+	case Shape::Format::Plaintext:
+		_mode = Mode::PlainRow;
+		return Feed(&c, 1);
+
+	case Shape::Format::RLE:
+		_mode = Mode::RleBody;
+		return _headerSeen && RleBody(c);
+
+	case Shape::Format::Life106:
+		_mode = Mode::Coordinates;
+		return Coordinate(c);
+
+	default:
 		return false;
 	}
+}
 
-	std::string line{0};
-	while (std::getline(_stream, line))
+bool ShapeParser::TextLine()
+{
+	const std::string_view line{ _text };
+
+	if (line.starts_with("#Life"))
 	{
-		if (line.empty())
-			continue;
+		// 1.05 draws the cells in blocks, it's rare enough not to bother with
+		if (_shape._format != Shape::Format::Unknown || !line.starts_with("#Life 1.06"))
+		{
+			return false;
+		}
+		_shape._format = Shape::Format::Life106;
+		return true;
+	}
+
+	if (line[0] == 'x')
+	{
+		_shape._format = Shape::Format::RLE;
+		return RleHeader(line);
+	}
+
+	if (_shape._format == Shape::Format::Unknown)
+	{
+		_shape._format = (line[0] == '!') ? Shape::Format::Plaintext : Shape::Format::RLE;
+	}
+
+	// #r is the rule in older RLE files, #P and #R place the pattern and mean nothing here
+	if (line.starts_with("#r"))
+	{
+		_shape._rule = Trim(line.substr(2));
+	}
+	else if (!line.starts_with("#P") && !line.starts_with("#R"))
+	{
+		_shape._notes.emplace_back(line);
+	}
+	return true;
+}
 
-		if (line[0] == '!')
+// x = 3, y = 3, rule = B3/S23
+bool ShapeParser::RleHeader(std::string_view header)
+{
+	uint64_t width = 0;
+	uint64_t height = 0;
+	bool hasWidth = false;
+	bool hasHeight = false;
+	while (!header.empty())
+	{
+		const std::string_view rest = header;
+		const size_t comma = header.find(',');
+		const std::string_view field = header.substr(0, comma);
+		header = (comma == std::string_view::npos) ? std::string_view{} : header.substr(comma + 1);
+
+		const size_t equals = field.find('=');
+		if (equals == std::string_view::npos)
 		{
-			_notes.push_back(line);
 			continue;
 		}
+		const std::string_view key = Trim(field.substr(0, equals));
+		const std::string_view value = Trim(field.substr(equals + 1));
 
-		_textcells.push_back(line);
+		if (key == "x" || key == "y")
+		{
+			uint64_t number = 0;
+			for (const char c : value)
+			{
+				if (!IsDigit(c) || number > MaxSide)
+				{
+					return false;
+				}
+				number = (number * 10) + gsl::narrow_cast<uint64_t>(c - '0');
+			}
+			(key == "x" ? width : height) = number;
+			(key == "x" ? hasWidth : hasHeight) = true;
+		}
+		else if (key == "rule")
+		{
+			// the rule is the rest of the line, it can have commas of its own, as in B3/S23:T10,10
+			_shape._rule = Trim(rest.substr(equals + 1));
+			break;
+		}
 	}
-	_stream.close();
 
-	_name = _path.filename().string();
+	_headerSeen = true;
+	return hasWidth && hasHeight && _shape.Size(width, height);
+}
 
-	Dump();
+// b and . are dead, o and A are alive, other states are read as dead since CopyShape only turns cells on
+bool ShapeParser::RleBody(char c) noexcept
+{
+	if (IsDigit(c))
+	{
+		if (_run > MaxSide * 16)
+		{
+			return false;
+		}
+		_run = (_run * 10) + gsl::narrow_cast<uint32_t>(c - '0');
+		return true;
+	}
+
+	const uint32_t run = std::max(_run, 1u);
+	if (c == '$')
+	{
+		_y += run;
+		_x = 0;
+	}
+	else if ((c == 'o' || c == 'A') && !_statePrefix)
+	{
+		// the header sets the size, anything past it is left out
+		if (_y < _shape._height && _x < _shape._width)
+		{
+			_shape.SetRun(_x, _y, std::min(run, _shape._width - _x));
+		}
+		_x += run;
+	}
+	else if (c == 'b' || c == '.' || (c >= 'A' && c <= 'X'))
+	{
+		_x += run;
+		_statePrefix = false;
+	}
+	else if (c >= 'p' && c <= 'y')
+	{
+		// the first letter of a two letter state, which is 25 or more
+		_statePrefix = true;
+		return true;
+	}
+	else if (c == '!')
+	{
+		_mode = Mode::Done;
+	}
+	else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+	{
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+	_run = 0;
+	return true;
+}
+
+// one "x y" pair a line, either can be negative
+bool ShapeParser::Coordinate(char c)
+{
+	if (IsDigit(c))
+	{
+		if (_number > MaxSide * 16)
+		{
+			return false;
+		}
+		_number = (_number * 10) + (c - '0');
+		_inNumber = true;
+		return true;
+	}
+
+	if (c == '-' && !_inNumber && !_negative)
+	{
+		_negative = true;
+		return true;
+	}
+
+	if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+	{
+		return false;
+	}
 
-	Parse();
+	if (_inNumber)
+	{
+		if (_fields == 2)
+		{
+			return false;
+		}
+		_coordinates[_fields++] = _negative ? -_number : _number;
+		_number = 0;
+		_negative = false;
+		_inNumber = false;
+	}
 
+	if (c == '\n')
+	{
+		if (_fields != 2)
+		{
+			return false;
+		}
+		_minX = std::min(_minX, _coordinates[0]);
+		_maxX = std::max(_maxX, _coordinates[0]);
+		_minY = std::min(_minY, _coordinates[1]);
+		_maxY = std::max(_maxY, _coordinates[1]);
+		if (_maxX - _minX >= MaxSide || _maxY - _minY >= MaxSide)
+		{
+			return false;
+		}
+		_points.push_back(gsl::narrow_cast<int32_t>(_coordinates[0]));
+		_points.push_back(gsl::narrow_cast<int32_t>(_coordinates[1]));
+		_fields = 0;
+		_mode = Mode::LineStart;
+	}
 	return true;
 }
 
-void Shape::Dump()
+void ShapeParser::EndPlainRow() noexcept
 {
-	#ifdef ML_LOGGING
-	ML_TRACE(_name);
-	for (const auto& note : _notes)
+	// the widest row sets the width, since rows can stop at their last live cell
+	_maxX = std::max(_maxX, gsl::narrow_cast<int64_t>(_x) - 1);
+	_x = 0;
+	_y++;
+	_mode = Mode::LineStart;
+}
+
+bool ShapeParser::Finish()
+{
+	// the last line doesn't have to end in a newline
+	if (_mode == Mode::Text)
 	{
-		ML_TRACE(note);
+		_mode = Mode::LineStart;
+		if (!TextLine())
+		{
+			return false;
+		}
+	}
+	else if (_mode == Mode::PlainRow)
+	{
+		EndPlainRow();
+	}
+	else if (_mode == Mode::Coordinates && (_inNumber || _fields > 0) && !Coordinate('\n'))
+	{
+		return false;
 	}
 
-	for (const auto& cell : _textcells)
+	switch (_shape._format)
 	{
-		ML_TRACE(cell);
+	case Shape::Format::RLE:
+		return _headerSeen;
+
+	case Shape::Format::Plaintext:
+		if (!_shape.Size(gsl::narrow_cast<uint64_t>(std::max(_maxX + 1, int64_t{ 0 })), _y))
+		{
+			return false;
+		}
+		for (size_t i = 0; i < _points.size(); i += 2)
+		{
+			_shape.SetRun(gsl::narrow_cast<uint32_t>(_points[i]), gsl::narrow_cast<uint32_t>(_points[i + 1]), 1);
+		}
+		return true;
+
+	case Shape::Format::Life106:
+		if (_points.empty())
+		{
+			return _shape.Size(0, 0);
+		}
+		if (!_shape.Size(gsl::narrow_cast<uint64_t>(_maxX - _minX + 1), gsl::narrow_cast<uint64_t>(_maxY - _minY + 1)))
+		{
+			return false;
+		}
+		for (size_t i = 0; i < _points.size(); i += 2)
+		{
+			_shape.SetRun(gsl::narrow_cast<uint32_t>(_points[i] - _minX), gsl::narrow_cast<uint32_t>(_points[i + 1] - _minY), 1);
+		}
+		return true;
+
+	default:
+		return false;
 	}
-	#endif
 }
 
-void Shape::Parse()
+bool Shape::Load()
 {
 	ML_METHOD;
 
-	// get the width and height of the shape
-	// since the file will not always contain full rows
-	_height = gsl::narrow_cast<uint16_t>(_textcells.size());
-	_width = 0;
-	for (const auto& row : _textcells)
+	_name = _path.filename().string();
+
+	// the parsers walk the mapped file in place, nothing is read into buffers
+	const MappedFile file(_path);
+	if (!file.IsOpen())
 	{
-		if (row.size() > _width)
-			_width = gsl::narrow_cast<uint16_t>(row.size());
+		ML_TRACE("Failed to open file: {}", _path.string());
+		return false;
 	}
 
-	// set the max dimension (width or height)
-	if (_width > _height)
+	return Load(file.Text());
+}
+
+bool Shape::Load(std::string_view text)
+{
+	ML_METHOD;
+
+	Reset();
+
+	bool loaded = false;
+	if (text.starts_with("[M2]"))
 	{
-		_maxdim = _width;
+		loaded = LoadMacrocell(text);
 	}
 	else
 	{
-		_maxdim = _height;
+		ShapeParser parser(*this);
+		loaded = parser.Feed(text.data(), text.size()) && parser.Finish();
 	}
+	return Loaded(loaded);
+}
 
-	// create a vector of Cells that is the right size, initialize to all dead Cells
-	_cells.resize(_width * _height);
+bool Shape::Load(std::istream& stream)
+{
+	ML_METHOD;
+
+	// macrocell lines refer back to any line before them, so it isn't read a block at a time
+	if (stream.peek() == '[')
+	{
+		const std::string text{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+		return Load(std::string_view{ text });
+	}
+
+	Reset();
 
-	int x = 0;
-	int y = 0;
-	for (const auto& row : _textcells)
+	ShapeParser parser(*this);
+	std::vector<char> block(BlockSize);
+	while (stream)
 	{
-		for (const auto& cell : row)
+		stream.read(block.data(), gsl::narrow_cast<std::streamsize>(block.size()));
+		const auto read = gsl::narrow_cast<size_t>(stream.gcount());
+		if (read == 0)
 		{
-			if (cell == 'O')
+			break;
+		}
+		if (!parser.Feed(block.data(), read))
+		{
+			return Loaded(false);
+		}
+	}
+	return Loaded(parser.Finish());
+}
+
+void Shape::Reset()
+{
+	_format = Format::Unknown;
+	_rule.clear();
+	_notes.clear();
+	Size(0, 0);
+}
+
+bool Shape::Loaded(bool loaded)
+{
+	if (!loaded)
+	{
+		ML_TRACE("Not a pattern: {}", _path.string());
+		Size(0, 0);
+		return false;
+	}
+
+	Dump();
+
+	return true;
+}
+
+// the nodes are kept with the box around each one's live cells, so a pattern too big for a shape fails before anything is drawn
+// and drawing only goes down into nodes with live cells
+bool Shape::LoadMacrocell(std::string_view text)
+{
+	ML_METHOD;
+
+	_format = Format::Macrocell;
+
+	// relative to the node's top left corner, right and bottom are one past the last live cell, empty if left == right
+	struct Bounds
+	{
+		int64_t left{ 0 };
+		int64_t top{ 0 };
+		int64_t right{ 0 };
+		int64_t bottom{ 0 };
+	};
+
+	// line 0 is the empty child
+	std::vector<MacrocellNode> nodes(1);
+	std::vector<Bounds> bounds(1);
+
+	MacrocellReader reader(text);
+	MacrocellNode node;
+	while (reader.Next(node))
+	{
+		Bounds box{ std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min() };
+		const auto extend = [&box](int64_t left, int64_t top, int64_t right, int64_t bottom) noexcept
+			{
+				box.left = std::min(box.left, left);
+				box.top = std::min(box.top, top);
+				box.right = std::max(box.right, right);
+				box.bottom = std::max(box.bottom, bottom);
+			};
+
+		if (node.leaf)
+		{
+			uint64_t columns = 0;
+			for (int64_t y = 0; y < 8; y++)
 			{
-				// only turn on Cells if they are alive in the file
-				// otherwise do nothing (leave them dead)
-				_cells.at(y * _width + x).SetState(Cell::State::Live);
+				const uint64_t row = (node.cells >> (y * 8)) & 0xFF;
+				if (row != 0)
+				{
+					columns |= row;
+					extend(std::numeric_limits<int64_t>::max(), y, std::numeric_limits<int64_t>::min(), y + 1);
+				}
+			}
+			if (columns != 0)
+			{
+				extend(std::countr_zero(columns), box.top, 64 - std::countl_zero(columns), box.bottom);
 			}
-			x++;
 		}
-		x = 0;
-		y++;
+		else
+		{
+			const int64_t half = int64_t{ 1 } << (node.level - 1);
+			for (size_t i = 0; i < node.children.size(); i++)
+			{
+				const uint32_t child = node.children[i];
+				const int64_t left = gsl::narrow_cast<int64_t>(i % 2) * half;
+				const int64_t top = gsl::narrow_cast<int64_t>(i / 2) * half;
+				if (node.level == 1)
+				{
+					// cell states, anything but 0 is alive
+					if (child != 0)
+					{
+						extend(left, top, left + 1, top + 1);
+					}
+				}
+				else if (child != 0)
+				{
+					if (nodes[child].level != node.level - 1)
+					{
+						return false;
+					}
+					const Bounds& inner = bounds[child];
+					if (inner.left != inner.right)
+					{
+						extend(left + inner.left, top + inner.top, left + inner.right, top + inner.bottom);
+					}
+				}
+			}
+		}
+
+		nodes.push_back(node);
+		bounds.push_back(box.left < box.right ? box : Bounds{});
 	}
+
+	if (reader.Failed())
+	{
+		return false;
+	}
+	_rule = reader.RuleText();
+
+	const Bounds& box = bounds.back();
+	if (!Size(gsl::narrow_cast<uint64_t>(box.right - box.left), gsl::narrow_cast<uint64_t>(box.bottom - box.top)))
+	{
+		ML_TRACE("Macrocell pattern is {}x{}, too big for a shape", box.right - box.left, box.bottom - box.top);
+		return false;
+	}
+
+	// (left, top) is where the node's top left corner lands in the shape
+	const auto draw = [&](const auto& self, uint32_t line, int64_t left, int64_t top) -> void
+		{
+			const MacrocellNode& n = nodes[line];
+			if (line == 0 || bounds[line].left == bounds[line].right)
+			{
+				return;
+			}
+
+			if (n.leaf)
+			{
+				for (uint64_t cells = n.cells; cells != 0; cells &= cells - 1)
+				{
+					const int bit = std::countr_zero(cells);
+					SetRun(gsl::narrow_cast<uint32_t>(left + (bit % 8)), gsl::narrow_cast<uint32_t>(top + (bit / 8)), 1);
+				}
+				return;
+			}
+
+			const int64_t half = int64_t{ 1 } << (n.level - 1);
+			for (size_t i = 0; i < n.children.size(); i++)
+			{
+				const int64_t childLeft = left + (gsl::narrow_cast<int64_t>(i % 2) * half);
+				const int64_t childTop = top + (gsl::narrow_cast<int64_t>(i / 2) * half);
+				if (n.level > 1)
+				{
+					self(self, n.children[i], childLeft, childTop);
+				}
+				else if (n.children[i] != 0)
+				{
+					SetRun(gsl::narrow_cast<uint32_t>(childLeft), gsl::narrow_cast<uint32_t>(childTop), 1);
+				}
+			}
+		};
+	draw(draw, gsl::narrow_cast<uint32_t>(nodes.size() - 1), -box.left, -box.top);
+
+	return true;
+}
+
+bool Shape::Size(uint64_t width, uint64_t height)
+{
+	if (width > MaxSide || height > MaxSide)
+	{
+		return false;
+	}
+
+	_width = gsl::narrow_cast<uint16_t>(width);
+	_height = gsl::narrow_cast<uint16_t>(height);
+	_maxdim = std::max(_width, _height);
+	_wordsPerRow = (gsl::narrow_cast<size_t>(_width) + 63) / 64;
+	_bits.assign(_wordsPerRow * _height, 0);
+	_live = 0;
+	return true;
+}
+
+void Shape::SetRun(uint32_t x, uint32_t y, uint32_t count) noexcept
+{
+	uint64_t* row = &_bits[gsl::narrow_cast<size_t>(y) * _wordsPerRow];
+	while (count > 0)
+	{
+		const uint32_t bit = x % 64;
+		const uint32_t span = std::min(count, 64 - bit);
+		const uint64_t mask = (span == 64) ? ~uint64_t{ 0 } : (((uint64_t{ 1 } << span) - 1) << bit);
+		_live += gsl::narrow_cast<uint32_t>(std::popcount(mask & ~row[x / 64]));
+		row[x / 64] |= mask;
+		x += span;
+		count -= span;
+	}
+}
+
+void Shape::Dump()
+{
+	#ifdef ML_LOGGING
+	ML_TRACE(_name);
+	ML_TRACE("{}x{}, {} live, rule {}", _width, _height, _live, _rule);
+	for (const auto& note : _notes)
+	{
+		ML_TRACE(note);
+	}
+	#endif
 }
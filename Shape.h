@@ -1,15 +1,32 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <istream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <gsl/gsl>
+
 #include "Cell.h"
 
+// a pattern read from a file: plaintext .cells, RLE, Life 1.06 or Golly's macrocell, told apart by what the file starts with
+// the file is mapped, or a stream read in blocks, and decoded as it goes into one bit per cell, without keeping its lines around
+// RLE writes straight into the cells, since its header gives the size; plaintext and Life 1.06 collect the live cells first,
+// and macrocell keeps its quadtree nodes until it knows the pattern fits
 class Shape
 {
 public:
+	enum class Format : uint8_t
+	{
+		Unknown,
+		Plaintext,
+		RLE,
+		Life106,
+		Macrocell
+	};
+
 	Shape(std::filesystem::path& path)
 	{
 		_path = path;
@@ -22,7 +39,10 @@ public:
 
 	~Shape() = default;
 
+	// false if the file can't be opened or isn't a pattern, or the pattern is over 65535 cells across
 	bool Load();
+	bool Load(std::string_view text);
+	bool Load(std::istream& stream);
 	void Dump();
 
 	[[nodiscard]] uint16_t Width() noexcept
@@ -45,34 +65,58 @@ public:
 		return _name;
 	}
 
+	[[nodiscard]] Format GetFormat() const noexcept
+	{
+		return _format;
+	}
+
+	// the rule the file asks for, RLE's "rule =" or #r, empty if it doesn't say
+	[[nodiscard]] const std::string& RuleText() const noexcept
+	{
+		return _rule;
+	}
+
 	[[nodiscard]] std::vector<std::string>& GetNotes() noexcept
 	{
 		return _notes;
 	}
 
-	[[nodiscard]] std::vector<Cell>& GetCells() noexcept
+	[[nodiscard]] uint32_t GetLiveCount() const noexcept
 	{
-		return _cells;
+		return _live;
 	}
 
-	[[nodiscard]] bool IsAlive(uint16_t x, uint16_t y)
+	[[nodiscard]] bool IsAlive(uint16_t x, uint16_t y) const noexcept
 	{
-		return _cells.at(x + y * _width).IsAlive();
+		return (_bits[(gsl::narrow_cast<size_t>(y) * _wordsPerRow) + (x / 64)] >> (x % 64)) & 1;
 	}
 
 private:
-	void Parse();
+	friend class ShapeParser;
+
+	void Reset();
+	bool Loaded(bool loaded);
+	bool LoadMacrocell(std::string_view text);
+
+	// makes an empty shape of the given size, false if it's too big
+	bool Size(uint64_t width, uint64_t height);
+
+	// turns on count cells from (x, y) going right, a word at a time
+	void SetRun(uint32_t x, uint32_t y, uint32_t count) noexcept;
 
 	uint16_t _width{ 0 };
 	uint16_t _height{ 0 };
 	uint16_t _maxdim{ 0 };
 
 	std::filesystem::path _path;
-	std::ifstream _stream;
 
 	std::string _name{ 0 };
+	std::string _rule;
 	std::vector<std::string> _notes;
-	std::vector<std::string> _textcells;
+	Format _format{ Format::Unknown };
 
-	std::vector<Cell> _cells;
-};
\ No newline at end of file
+	// row after row, each row a whole number of 64 bit words, bit x % 64 of word x / 64 is the cell at x
+	std::vector<uint64_t> _bits;
+	size_t _wordsPerRow{ 0 };
+	uint32_t _live{ 0 };
+};
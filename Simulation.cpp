@@ -0,0 +1,158 @@
+#include "pch.h"
+
+#include "Simulation.h"
+
+void Simulation::Start()
+{
+	Stop();
+	_thread = std::jthread{ [this](std::stop_token stoken) { Loop(stoken); } };
+}
+
+void Simulation::Stop()
+{
+	if (_thread.joinable())
+	{
+		_thread.request_stop();
+		_thread.join();
+	}
+}
+
+void Simulation::Running(bool running)
+{
+	{
+		std::scoped_lock lock{ _lockedits };
+		_running = running;
+	}
+	_wake.notify_one();
+}
+
+void Simulation::Rules(BoardRules rules)
+{
+	std::scoped_lock lock{ _lockedits };
+	_rules = rules;
+	_customRule.reset();
+	_rulesChanged = true;
+}
+
+void Simulation::Rules(const Rule& rule)
+{
+	std::scoped_lock lock{ _lockedits };
+	_customRule = rule;
+	_rulesChanged = true;
+}
+
+void Simulation::StepsPerSecond(int rate)
+{
+	{
+		std::scoped_lock lock{ _lockedits };
+		_rate = std::max(rate, FullSpeed);
+	}
+	_wake.notify_one();
+}
+
+void Simulation::Post(Edit edit)
+{
+	{
+		std::scoped_lock lock{ _lockedits };
+		_edits.push_back(std::move(edit));
+	}
+	_wake.notify_one();
+}
+
+void Simulation::Loop(std::stop_token stoken)
+{
+	using clock = std::chrono::steady_clock;
+
+	Publish();
+
+	std::vector<Edit> edits;
+	std::optional<Rule> customRule;
+	clock::time_point due = clock::now();
+	clock::time_point measured = due;
+	uint64_t generations = 0;
+	bool unpublished = false;
+	while (!stoken.stop_requested())
+	{
+		{
+			// sleep until the next step is due, something is posted, or the board is paused or started
+			// a paused board publishes what it computed last before it sleeps
+			std::unique_lock lock{ _lockedits };
+			if (_running)
+			{
+				_wake.wait_until(lock, stoken, due, [this] { return !_edits.empty() || !_running; });
+			}
+			else
+			{
+				_measuredRate = 0.0;
+				if (!unpublished)
+				{
+					_wake.wait(lock, stoken, [this] { return !_edits.empty() || _running; });
+				}
+				due = clock::now();
+				measured = due;
+				generations = 0;
+			}
+			edits.swap(_edits);
+			if (_rulesChanged)
+			{
+				customRule = _customRule;
+				_rulesChanged = false;
+			}
+		}
+		if (stoken.stop_requested())
+		{
+			break;
+		}
+
+		bool changed = !edits.empty();
+		for (Edit& edit : edits)
+		{
+			edit(_board);
+		}
+		edits.clear();
+
+		const clock::time_point now = clock::now();
+		if (_running && now >= due)
+		{
+			const BoardRules rules = _rules;
+			const uint32_t step = _generationsPerStep;
+			const uint32_t before = _board.Generation();
+			if (customRule)
+			{
+				_board.Update(*customRule, step);
+			}
+			else
+			{
+				_board.Update(rules, step);
+			}
+			_stepTime = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - now).count();
+			// a board paused on a cycle skips the step, so count what it computed rather than what was asked for
+			generations += _board.Generation() - before;
+			changed = true;
+
+			// a board that falls behind runs as fast as it can rather than catching up in a burst
+			due = std::max(due + Period(), now);
+		}
+
+		if (now - measured >= MeasureInterval)
+		{
+			_measuredRate = gsl::narrow_cast<double>(generations) / std::chrono::duration<double>(now - measured).count();
+			measured = now;
+			generations = 0;
+		}
+
+		// copying a snapshot costs about as much as a generation, so at full speed there's no copy the UI won't draw
+		unpublished = unpublished || changed;
+		if (unpublished && (!AtFullSpeed() || !_snapshots.IsFresh()))
+		{
+			Publish();
+			unpublished = false;
+		}
+	}
+}
+
+void Simulation::Publish()
+{
+	_board.Snapshot(_snapshots.Back());
+	_snapshots.Publish();
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "TripleBuffer.h"
+
+// runs a Board on a thread of its own, so a slow generation never holds up a frame and a slow frame never holds up a generation
+// after every generation and every edit the board is copied into a snapshot, and the UI thread draws the newest one
+// once Start is called the board is only changed through Post, the edits run on the simulation thread between generations
+// at full speed generations are computed back to back, and a snapshot is only copied once the last one was taken
+class Simulation
+{
+public:
+    using Edit = std::function<void(Board&)>;
+
+    // construct
+    explicit Simulation(Board& board) noexcept : _board(board)
+    {
+    }
+
+    // copy/move not needed
+    Simulation(Simulation&&) = delete;
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(Simulation&&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // destruct
+    ~Simulation()
+    {
+        Stop();
+    }
+
+    // starts the simulation thread, paused, and publishes the first snapshot
+    void Start();
+    void Stop();
+
+    // computes generations while running, only runs edits while paused
+    void Running(bool running);
+
+    [[nodiscard]] bool Running() const noexcept
+    {
+        return _running;
+    }
+
+    // one of the presets, replaces a rule set with the overload below
+    void Rules(BoardRules rules);
+
+    // any other rule, e.g. the one a pattern file names; the preset still reports what was chosen last
+    void Rules(const Rule& rule);
+
+    [[nodiscard]] BoardRules Rules() const noexcept
+    {
+        return _rules;
+    }
+
+    // how many steps a second are taken while running, FullSpeed for as many as the board can do
+    static constexpr int FullSpeed{ 0 };
+    void StepsPerSecond(int rate);
+
+    [[nodiscard]] int StepsPerSecond() const noexcept
+    {
+        return _rate;
+    }
+
+    // how many generations a step computes, FastConway on the bit-packed board and other B/S rules in temporal blocks when the board
+    // isn't kept for rewinding; a snapshot is published after every step
+    void GenerationsPerStep(uint32_t generations) noexcept
+    {
+        _generationsPerStep = std::max(generations, 1u);
+    }
+
+    [[nodiscard]] uint32_t GenerationsPerStep() const noexcept
+    {
+        return _generationsPerStep;
+    }
+
+    // how long the last step took to compute
+    [[nodiscard]] std::chrono::nanoseconds LastStepTime() const noexcept
+    {
+        return std::chrono::nanoseconds{ _stepTime.load() };
+    }
+
+    // generations computed a second, measured over the last half second or so, 0 while paused
+    [[nodiscard]] double MeasuredGenerationsPerSecond() const noexcept
+    {
+        return _measuredRate;
+    }
+
+    // runs the edit on the simulation thread before the next generation, edits run in the order they were posted
+    void Post(Edit edit);
+
+    // true if a snapshot was published since Latest last took one
+    [[nodiscard]] bool HasNewSnapshot() const noexcept
+    {
+        return _snapshots.IsFresh();
+    }
+
+    // the newest snapshot, only for the thread that draws; it stays the same until the next call
+    [[nodiscard]] const BoardSnapshot& Latest() noexcept
+    {
+        _snapshots.Acquire();
+        return _snapshots.Front();
+    }
+
+private:
+    void Loop(std::stop_token stoken);
+    void Publish();
+
+    [[nodiscard]] std::chrono::nanoseconds Period() const noexcept
+    {
+        const int rate = _rate;
+        return rate == FullSpeed ? std::chrono::nanoseconds{ 0 } : std::chrono::nanoseconds{ std::chrono::seconds{ 1 } } / rate;
+    }
+
+    [[nodiscard]] bool AtFullSpeed() const noexcept
+    {
+        return _running && _rate == FullSpeed;
+    }
+
+    static constexpr std::chrono::milliseconds MeasureInterval{ 500 };
+
+    Board& _board;
+    TripleBuffer<BoardSnapshot> _snapshots;
+
+    // guards _edits and the custom rule, and _running and _rate for the wait in Loop
+    std::mutex _lockedits;
+    std::condition_variable_any _wake;
+    std::vector<Edit> _edits;
+    std::optional<Rule> _customRule;
+    bool _rulesChanged{ false };
+
+    std::atomic<BoardRules> _rules{ BoardRules::FastConway };
+    std::atomic<bool> _running{ false };
+    std::atomic<int> _rate{ 30 };
+    std::atomic<uint32_t> _generationsPerStep{ 1 };
+    std::atomic<double> _measuredRate{ 0.0 };
+    std::atomic<int64_t> _stepTime{ 0 };
+
+    std::jthread _thread;
+};
@@ -0,0 +1,269 @@
+#include "pch.h"
+
+#include "SparseBoard.h"
+#include "Board.h"
+#include "BitBoard.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_set>
+
+namespace
+{
+	// the cells of one chunk row and their west and east neighbors, which can come from the chunks on either side
+	struct RowNeighbors
+	{
+		uint64_t west;
+		uint64_t row;
+		uint64_t east;
+	};
+
+	inline RowNeighbors NeighborsOf(const uint64_t* westRow, uint64_t row, const uint64_t* eastRow) noexcept
+	{
+		const uint64_t westBit = westRow ? (*westRow >> 63) : 0;
+		const uint64_t eastBit = eastRow ? ((*eastRow & 1) << 63) : 0;
+		return RowNeighbors{ (row << 1) | westBit, row, (row >> 1) | eastBit };
+	}
+}
+
+SparseBoard::SparseBoard()
+{
+	ML_METHOD;
+
+	int threadcount = gsl::narrow_cast<int>(std::thread::hardware_concurrency() / 2);
+	threadcount = std::clamp(threadcount, 2, 8);
+
+	_pool.Start(threadcount);
+	_partialPopulation.resize(threadcount);
+}
+
+void SparseBoard::Clear()
+{
+	_chunks.clear();
+	_generation = 0;
+	_population = 0;
+}
+
+void SparseBoard::SetCell(int64_t x, int64_t y, bool alive)
+{
+	const ChunkKey key = KeyOf(x, y);
+	const uint64_t bit = uint64_t{ 1 } << (x & 63);
+
+	if (alive)
+	{
+		uint64_t& row = _chunks[key][y & 63];
+		_population += (row & bit) ? 0 : 1;
+		row |= bit;
+		return;
+	}
+
+	auto found = _chunks.find(key);
+	if (found == _chunks.end())
+	{
+		return;
+	}
+
+	uint64_t& row = found->second[y & 63];
+	_population -= (row & bit) ? 1 : 0;
+	row &= ~bit;
+
+	// a chunk with no live cells isn't kept
+	if (std::all_of(found->second.begin(), found->second.end(), [](uint64_t r) { return r == 0; }))
+	{
+		_chunks.erase(found);
+	}
+}
+
+bool SparseBoard::GetCell(int64_t x, int64_t y) const
+{
+	const Chunk* chunk = Find(KeyOf(x, y));
+	return chunk && (((*chunk)[y & 63] >> (x & 63)) & 1);
+}
+
+void SparseBoard::LoadShape(Shape& shape, int64_t left, int64_t top)
+{
+	ML_METHOD;
+
+	for (uint16_t y = 0; y < shape.Height(); y++)
+	{
+		for (uint16_t x = 0; x < shape.Width(); x++)
+		{
+			if (shape.IsAlive(x, y))
+			{
+				SetCell(left + x, top + y, true);
+			}
+		}
+	}
+}
+
+const SparseBoard::Chunk* SparseBoard::Find(const ChunkKey& key) const noexcept
+{
+	const auto found = _chunks.find(key);
+	return (found == _chunks.end()) ? nullptr : &found->second;
+}
+
+void SparseBoard::FindCandidates()
+{
+	std::unordered_set<ChunkKey, ChunkKeyHash> candidates;
+	candidates.reserve(_chunks.size() * 2);
+
+	for (const auto& [key, chunk] : _chunks)
+	{
+		candidates.insert(key);
+
+		uint64_t westEdge = 0;
+		uint64_t eastEdge = 0;
+		for (const uint64_t row : chunk)
+		{
+			westEdge |= row & 1;
+			eastEdge |= row >> 63;
+		}
+		const uint64_t northRow = chunk.front();
+		const uint64_t southRow = chunk.back();
+
+		// a live cell on an edge can give birth in the chunk on the other side of it
+		const auto add = [&](int64_t dx, int64_t dy, bool touches)
+		{
+			if (touches)
+			{
+				candidates.insert(ChunkKey{ key.x + dx, key.y + dy });
+			}
+		};
+		add(0, -1, northRow != 0);
+		add(0, 1, southRow != 0);
+		add(-1, 0, westEdge != 0);
+		add(1, 0, eastEdge != 0);
+		add(-1, -1, (northRow & 1) != 0);
+		add(1, -1, (northRow >> 63) != 0);
+		add(-1, 1, (southRow & 1) != 0);
+		add(1, 1, (southRow >> 63) != 0);
+	}
+
+	_candidates.assign(candidates.begin(), candidates.end());
+}
+
+// writes the next generation of one chunk and returns its population
+uint64_t SparseBoard::StepChunk(const ChunkKey& key, const Rule& rule, Chunk& next) const noexcept
+{
+	const uint16_t birth = rule.Birth() & ~uint16_t{ 1 };
+	const uint16_t survival = rule.Survival();
+
+	// the chunk and its 8 neighbors, missing chunks are empty
+	std::array<const Chunk*, 9> around{};
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			around[(dy + 1) * 3 + (dx + 1)] = Find(ChunkKey{ key.x + dx, key.y + dy });
+		}
+	}
+
+	// row r of the chunks in one band (0 north, 1 this one, 2 south), with west and east neighbors
+	const auto bandRow = [&around](int band, int r) noexcept
+	{
+		const Chunk* west = around[band * 3];
+		const Chunk* middle = around[band * 3 + 1];
+		const Chunk* east = around[band * 3 + 2];
+		return NeighborsOf(west ? &(*west)[r] : nullptr, middle ? (*middle)[r] : 0, east ? &(*east)[r] : nullptr);
+	};
+
+	uint64_t population = 0;
+	for (int r = 0; r < ChunkSize; r++)
+	{
+		const RowNeighbors above = (r == 0) ? bandRow(0, ChunkSize - 1) : bandRow(1, r - 1);
+		const RowNeighbors row = bandRow(1, r);
+		const RowNeighbors below = (r == ChunkSize - 1) ? bandRow(2, 0) : bandRow(1, r + 1);
+
+		const BitBoard::NeighborCounts count = BitBoard::AddNeighbors(above.west, above.row, above.east, row.west, row.east, below.west, below.row, below.east);
+		const uint64_t result = (~row.row & count.Matching(birth)) | (row.row & count.Matching(survival));
+
+		next[r] = result;
+		population += std::popcount(result);
+	}
+	return population;
+}
+
+void SparseBoard::Update(const Rule& rule)
+{
+	ML_METHOD;
+
+	FindCandidates();
+	_results.resize(_candidates.size());
+
+	// every range steps its share of the candidates, only reading _chunks
+	const int ranges = _pool.ThreadCount();
+	_pool.RunRowRanges(gsl::narrow_cast<uint16_t>(ranges), [this, &rule, ranges](int range, uint16_t, uint16_t)
+		{
+			const size_t start = _candidates.size() * range / ranges;
+			const size_t end = _candidates.size() * (range + 1) / ranges;
+
+			uint64_t population = 0;
+			for (size_t i = start; i < end; i++)
+			{
+				population += StepChunk(_candidates[i], rule, _results[i]);
+			}
+			_partialPopulation[range] = population;
+		});
+
+	// keep the chunks that have live cells, drop the rest
+	ChunkMap next;
+	next.reserve(_candidates.size());
+	for (size_t i = 0; i < _candidates.size(); i++)
+	{
+		const Chunk& chunk = _results[i];
+		if (std::any_of(chunk.begin(), chunk.end(), [](uint64_t r) { return r != 0; }))
+		{
+			next.emplace(_candidates[i], chunk);
+		}
+	}
+	_chunks.swap(next);
+
+	_population = 0;
+	for (auto& population : _partialPopulation)
+	{
+		_population += population;
+		population = 0;
+	}
+	_generation++;
+}
+
+void SparseBoard::CopyToBoard(Board& board, int64_t left, int64_t top) const
+{
+	ML_METHOD;
+
+	board.Clear();
+
+	const int64_t right = left + board.Width();
+	const int64_t bottom = top + board.Height();
+
+	for (const auto& [key, chunk] : _chunks)
+	{
+		const int64_t chunkLeft = key.x * ChunkSize;
+		const int64_t chunkTop = key.y * ChunkSize;
+		if (chunkLeft + ChunkSize <= left || chunkLeft >= right || chunkTop + ChunkSize <= top || chunkTop >= bottom)
+		{
+			continue;
+		}
+
+		for (int r = 0; r < ChunkSize; r++)
+		{
+			const int64_t y = chunkTop + r;
+			if (y < top || y >= bottom)
+			{
+				continue;
+			}
+
+			uint64_t bits = chunk[r];
+			while (bits != 0)
+			{
+				const int64_t x = chunkLeft + std::countr_zero(bits);
+				bits &= bits - 1;
+				if (x >= left && x < right)
+				{
+					board.TurnCellOn(GridPoint{ gsl::narrow_cast<uint16_t>(x - left), gsl::narrow_cast<uint16_t>(y - top) }, true);
+				}
+			}
+		}
+	}
+}
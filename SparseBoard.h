@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Rule.h"
+#include "Shape.h"
+#include "ThreadPool.h"
+
+class Board;
+
+// SparseBoard is an unbounded board, nothing wraps
+// the plane is cut into 64x64 chunks and only chunks with live cells are stored, in a hash map keyed by chunk coordinates,
+// so memory and the cost of a generation follow the live cells, not their bounding box
+// a chunk is 64 rows of 64 bits, bit b of row r is the cell at (chunk x * 64 + b, chunk y * 64 + r)
+// like Board, x grows right and y grows down
+class SparseBoard
+{
+public:
+    static constexpr int ChunkSize{ 64 };
+
+    SparseBoard();
+    ~SparseBoard() = default;
+
+    // copy/move not needed
+    SparseBoard(SparseBoard&& b) = delete;
+    SparseBoard(SparseBoard& b) = delete;
+    SparseBoard& operator=(SparseBoard&& b) = delete;
+    SparseBoard& operator=(SparseBoard& b) = delete;
+
+    void Clear();
+
+    void SetCell(int64_t x, int64_t y, bool alive);
+    [[nodiscard]] bool GetCell(int64_t x, int64_t y) const;
+
+    // places the shape with its top left cell at (left, top)
+    void LoadShape(Shape& shape, int64_t left, int64_t top);
+
+    // B/S rules, a Generations rule runs as its B/S part
+    // B0 would fill the whole plane, so it's ignored
+    void Update(const Rule& rule);
+
+    // clears the board and copies the window of the plane that starts at (left, top) into it
+    void CopyToBoard(Board& board, int64_t left, int64_t top) const;
+
+    [[nodiscard]] uint64_t Generation() const noexcept
+    {
+        return _generation;
+    }
+
+    [[nodiscard]] uint64_t Population() const noexcept
+    {
+        return _population;
+    }
+
+    [[nodiscard]] size_t ChunkCount() const noexcept
+    {
+        return _chunks.size();
+    }
+
+private:
+    using Chunk = std::array<uint64_t, ChunkSize>;
+
+    struct ChunkKey
+    {
+        int64_t x;
+        int64_t y;
+
+        bool operator==(const ChunkKey& other) const noexcept
+        {
+            return x == other.x && y == other.y;
+        }
+    };
+
+    struct ChunkKeyHash
+    {
+        size_t operator()(const ChunkKey& key) const noexcept
+        {
+            uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<uint64_t>(key.y) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    using ChunkMap = std::unordered_map<ChunkKey, Chunk, ChunkKeyHash>;
+
+    [[nodiscard]] static ChunkKey KeyOf(int64_t x, int64_t y) noexcept
+    {
+        // arithmetic shift, so -1 is in chunk -1
+        return ChunkKey{ x >> 6, y >> 6 };
+    }
+
+    [[nodiscard]] const Chunk* Find(const ChunkKey& key) const noexcept;
+    void FindCandidates();
+    [[nodiscard]] uint64_t StepChunk(const ChunkKey& key, const Rule& rule, Chunk& next) const noexcept;
+
+    ChunkMap _chunks;
+    // the chunks that could have live cells next generation: every live chunk and the neighbors its edge cells touch
+    std::vector<ChunkKey> _candidates;
+    std::vector<Chunk> _results;
+    std::vector<uint64_t> _partialPopulation;
+    ThreadPool _pool;
+
+    uint64_t _generation{ 0 };
+    uint64_t _population{ 0 };
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A long-lived set of worker threads for work that is split into row ranges.
+// RunRowRanges hands each worker one range (and its index, so workers can keep per-range results), runs the last range on the calling thread,
+// and returns once every range is done, so a generation costs two wakeups instead of
+// creating and joining a thread per range.
+class ThreadPool
+{
+public:
+    using RowWork = std::function<void(int, uint16_t, uint16_t)>;
+
+    // construct
+    ThreadPool() = default;
+
+    // copy/move not needed
+    ThreadPool(ThreadPool&& b) = delete;
+    ThreadPool(ThreadPool& b) = delete;
+    ThreadPool& operator=(ThreadPool&& b) = delete;
+    ThreadPool& operator=(ThreadPool& b) = delete;
+
+    // destruct
+    ~ThreadPool()
+    {
+        Stop();
+    }
+
+    // threadcount includes the calling thread, so threadcount - 1 workers are created
+    void Start(int threadcount)
+    {
+        Stop();
+
+        // new workers must not mistake an earlier batch for a new one
+        const uint64_t batch = _batch;
+        _threadcount = std::max(threadcount, 1);
+        for (int i = 0; i < _threadcount - 1; i++)
+        {
+            _workers.emplace_back([this, i, batch](std::stop_token stoken) { WorkerLoop(stoken, i, batch); });
+        }
+    }
+
+    void Stop()
+    {
+        for (auto& worker : _workers)
+        {
+            worker.request_stop();
+        }
+        _wake.notify_all();
+
+        // jthread joins on destruction
+        _workers.clear();
+        _threadcount = 1;
+    }
+
+    [[nodiscard]] int ThreadCount() const noexcept
+    {
+        return _threadcount;
+    }
+
+    // splits [0, rows) into ThreadCount() ranges the same way Board always has:
+    // equal ranges with the remainder going to the last one
+    [[nodiscard]] std::pair<uint16_t, uint16_t> RowRange(int index, uint16_t rows) const noexcept
+    {
+        const auto rowsPerThread = static_cast<uint16_t>(rows / _threadcount);
+        const auto start = static_cast<uint16_t>(rowsPerThread * index);
+        const auto end = (index == _threadcount - 1) ? rows : static_cast<uint16_t>(start + rowsPerThread);
+        return { start, end };
+    }
+
+    // runs work(range, startRow, endRow) for every range and waits for all of them
+    // range is 0 to ThreadCount() - 1
+    void RunRowRanges(uint16_t rows, const RowWork& work)
+    {
+        // one batch at a time
+        std::scoped_lock run{ _runlock };
+
+        if (_workers.empty())
+        {
+            work(0, 0, rows);
+            return;
+        }
+
+        {
+            std::scoped_lock lock{ _lock };
+            _work = &work;
+            _rows = rows;
+            _pending = static_cast<int>(_workers.size());
+            _batch++;
+        }
+        _wake.notify_all();
+
+        const auto [start, end] = RowRange(_threadcount - 1, rows);
+        work(_threadcount - 1, start, end);
+
+        std::unique_lock lock{ _lock };
+        _done.wait(lock, [this] { return _pending == 0; });
+        _work = nullptr;
+    }
+
+private:
+    void WorkerLoop(std::stop_token stoken, int index, uint64_t seen)
+    {
+        while (true)
+        {
+            std::unique_lock lock{ _lock };
+            if (!_wake.wait(lock, stoken, [this, seen] { return _batch != seen; }))
+            {
+                // stop was requested
+                return;
+            }
+            seen = _batch;
+            const auto* work = _work;
+            const uint16_t rows = _rows;
+            lock.unlock();
+
+            const auto [start, end] = RowRange(index, rows);
+            (*work)(index, start, end);
+
+            lock.lock();
+            if (--_pending == 0)
+            {
+                _done.notify_one();
+            }
+        }
+    }
+
+private:
+    std::mutex _runlock;
+    std::mutex _lock;
+    std::condition_variable_any _wake;
+    std::condition_variable _done;
+    std::vector<std::jthread> _workers;
+
+    const RowWork* _work{ nullptr };
+    uint64_t _batch{ 0 };
+    int _pending{ 0 };
+    int _threadcount{ 1 };
+    uint16_t _rows{ 0 };
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// hands the newest of a stream of values from one writer thread to one reader thread without either waiting on the other
+// the writer fills Back() and Publish()es it, the reader Acquire()s the newest published one and reads Front() until its next Acquire
+// of the three buffers one is the writer's, one the reader's and one the newest published, so neither ever touches a buffer the other has
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // writer side
+    [[nodiscard]] T& Back() noexcept
+    {
+        return _buffers[_back];
+    }
+
+    // swaps the back buffer with the middle one and marks it fresh
+    void Publish() noexcept
+    {
+        const uint8_t previous = _middle.exchange(static_cast<uint8_t>(_back | Fresh), std::memory_order_acq_rel);
+        _back = static_cast<uint8_t>(previous & Index);
+    }
+
+    // reader side
+    // true if a value was published since the last Acquire
+    [[nodiscard]] bool IsFresh() const noexcept
+    {
+        return (_middle.load(std::memory_order_acquire) & Fresh) != 0;
+    }
+
+    // takes the newest published value if there is one, false if Front() is still the newest
+    bool Acquire() noexcept
+    {
+        if (!IsFresh())
+        {
+            return false;
+        }
+        const uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = static_cast<uint8_t>(previous & Index);
+        return true;
+    }
+
+    [[nodiscard]] const T& Front() const noexcept
+    {
+        return _buffers[_front];
+    }
+
+private:
+    static constexpr uint8_t Index{ 0x03 };
+    static constexpr uint8_t Fresh{ 0x04 };
+
+    std::array<T, 3> _buffers{};
+    uint8_t _back{ 0 };
+    uint8_t _front{ 1 };
+    // the middle buffer's index, and whether it was published since the reader last took it
+    std::atomic<uint8_t> _middle{ 2 };
+};
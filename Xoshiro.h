@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+// xoshiro256** by Blackman and Vigna, a small fast generator with a 2^256 - 1 period
+// Jump advances it by 2^128 calls, so one seed gives up to 2^128 streams that never overlap,
+// each stream can fill part of a board on its own thread and the result doesn't depend on who ran what
+// also a UniformRandomBitGenerator, so it works with the <random> distributions
+class Xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    // Bernoulli probabilities are fractions of this, 16 bits of precision
+    static constexpr uint32_t ProbabilityOne{ 1u << 16 };
+
+    // the seed is spread over the 256 bits of state with splitmix64, as the authors recommend
+    explicit Xoshiro256(uint64_t seed) noexcept
+    {
+        for (auto& word : _state)
+        {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    [[nodiscard]] static constexpr result_type min() noexcept
+    {
+        return 0;
+    }
+
+    [[nodiscard]] static constexpr result_type max() noexcept
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept
+    {
+        return Next();
+    }
+
+    uint64_t Next() noexcept
+    {
+        const uint64_t result = std::rotl(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = std::rotl(_state[3], 45);
+
+        return result;
+    }
+
+    // same as 2^128 calls to Next
+    void Jump() noexcept
+    {
+        constexpr std::array<uint64_t, 4> jump{ 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+
+        std::array<uint64_t, 4> state{};
+        for (const uint64_t word : jump)
+        {
+            for (int b = 0; b < 64; b++)
+            {
+                if ((word >> b) & 1)
+                {
+                    for (size_t i = 0; i < state.size(); i++)
+                    {
+                        state[i] ^= _state[i];
+                    }
+                }
+                Next();
+            }
+        }
+        _state = state;
+    }
+
+    // 64 bits, each set with probability / ProbabilityOne
+    // each bit compares a 16 bit random fraction with the probability, one bit of the fraction per call to Next,
+    // so 64 cells cost at most 16 calls and fewer when the probability has trailing zero bits
+    uint64_t Bernoulli(uint32_t probability) noexcept
+    {
+        if (probability == 0)
+        {
+            return 0;
+        }
+        if (probability >= ProbabilityOne)
+        {
+            return ~uint64_t{ 0 };
+        }
+
+        // from the lowest set bit of the probability up: a 1 bit ORs in random bits, a 0 bit ANDs them
+        int bit = std::countr_zero(probability);
+        uint64_t bits = Next();
+        for (bit++; bit < 16; bit++)
+        {
+            bits = ((probability >> bit) & 1) ? (bits | Next()) : (bits & Next());
+        }
+        return bits;
+    }
+
+    // 0 to bound - 1, by multiplying instead of dividing
+    uint32_t Below(uint32_t bound) noexcept
+    {
+        return static_cast<uint32_t>(((Next() >> 32) * bound) >> 32);
+    }
+
+private:
+    std::array<uint64_t, 4> _state{};
+};
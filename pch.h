@@ -3,6 +3,8 @@
 
 #pragma once
 
+// ML_HEADLESS builds the simulation without WinUI, e.g. the benchmarks in Bench on Linux
+#ifndef ML_HEADLESS
 #include <windows.h>
 #include <WinUser.h>
 #include <unknwn.h>
@@ -10,6 +12,7 @@
 #include <hstring.h>
 #include <Shobjidl.h>
 #include <directxmath.h>
+#endif
 
 #include <chrono>
 #include <locale>
@@ -20,7 +23,9 @@
 #include <random>
 #include <vector>
 #include <future>
+#ifndef ML_HEADLESS
 #include <format>
+#endif
 #include <sstream>
 #include <fstream>
 #include <filesystem>
@@ -30,6 +35,17 @@
 #include <utility>
 #include <source_location>
 #include <execution>
+#include <thread>
+#include <cstdint>
+
+#ifdef ML_HEADLESS
+#include <gsl/gsl>
+
+// MSVC has __debugbreak built in
+#ifndef _MSC_VER
+#define __debugbreak() __builtin_trap()
+#endif
+#else
 
 // Undefine GetCurrentTime macro to prevent
 // conflict with Storyboard::GetCurrentTime
@@ -65,4 +81,5 @@
 #include <wil/cppwinrt_helpers.h>
 
 #include <deps/gsl/include/gsl/gsl>
-#include <deps/wil/include/wil/cppwinrt_helpers.h>
\ No newline at end of file
+#include <deps/wil/include/wil/cppwinrt_helpers.h>
+#endif